@@ -0,0 +1,342 @@
+// Runs a fixed set of SupLang programs on every execution backend and reports
+// the median execution time, plus the dispatched instruction count for the
+// bytecode VMs. Parsing and compilation are excluded from the timings.
+//
+// It then runs one parsed program many times over on a pool of threads, each
+// run with its own Interpreter, and reports front-end throughput in MB/s over
+// a generated multi-megabyte script: lexing with each character scanning
+// kernel the CPU supports, a full parse, a parse that defers function bodies,
+// and decoding the tree from its TreeCache encoding.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AST/TreeCache.h"
+#include "Interpreter/ClosureCompiler.h"
+#include "Interpreter/ClosureInterpreter.h"
+#include "Interpreter/Environment.h"
+#include "Interpreter/Interpreter.h"
+#include "Interpreter/Resolver.h"
+#include "Interpreter/TypeChecker.h"
+#include "Lexer/Lexer.h"
+#include "Object/Object.h"
+#include "Optimizer/ConstantFolder.h"
+#include "Parser/Parser.h"
+#include "VM/Compiler.h"
+#include "VM/RegisterCompiler.h"
+#include "VM/RegisterVM.h"
+#include "VM/VM.h"
+
+namespace {
+
+struct Program {
+    const char *name;
+    const char *source;
+};
+
+const Program kPrograms[] = {
+    {"counter", R"(
+        int32 counter = 0;
+        while (counter < 200000) {
+            counter = counter + 1;
+        }
+        int32 result = counter;
+    )"},
+    {"arith", R"(
+        sum = def sum(int32 n) {
+            int32 i = 0;
+            int32 acc = 0;
+            while (i < n) {
+                acc = acc + i * 2 - i;
+                i = i + 1;
+            }
+            return acc;
+        };
+        int32 result = sum(200000);
+    )"},
+    {"calls", R"(
+        inc = def inc(int32 x) { return x + 1; };
+        int32 i = 0;
+        while (i < 100000) {
+            i = inc(i);
+        }
+        int32 result = i;
+    )"},
+    {"fib", R"(
+        fib = def fib(int32 n) {
+            if (n < 2) { return n; }
+            return fib(n - 1) + fib(n - 2);
+        };
+        int32 result = fib(22);
+    )"},
+};
+
+constexpr int kRuns = 5;
+
+struct Measurement {
+    double millis = 0;
+    uint64_t instructions = 0;
+    suplang::Value result;
+};
+
+// Parses, constant-folds and type-checks `source`, as the command-line driver
+// does.
+suplang::SyntaxTree Parse(const char *source) {
+    suplang::Lexer lexer(source);
+    suplang::Parser parser(lexer);
+    auto ast = parser.parseProgram();
+    suplang::ConstantFolder folder(ast.arena());
+    folder.fold(ast.get());
+    suplang::Resolver resolver(ast.arena());
+    resolver.resolve(ast.get());
+    suplang::TypeChecker checker;
+    checker.check(ast.get());
+    return ast;
+}
+
+double ElapsedMillis(const std::function<void()> &body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+Measurement RunInterpreter(const char *source, bool jit) {
+    Measurement m;
+    auto ast = Parse(source);
+    suplang::Interpreter interpreter;
+    if (jit)
+        interpreter.enableJit();
+    m.millis = ElapsedMillis([&] { interpreter.eval(ast.get()); });
+    m.result = interpreter.globals().get("result");
+    return m;
+}
+
+Measurement RunAst(const char *source) { return RunInterpreter(source, false); }
+
+// Includes compiling the functions to native code, which happens as they are
+// defined.
+Measurement RunJit(const char *source) { return RunInterpreter(source, true); }
+
+Measurement RunClosure(const char *source) {
+    Measurement m;
+    auto ast = Parse(source);
+    suplang::ClosureCompiler compiler;
+    auto program = compiler.compile(ast.get());
+    suplang::ClosureInterpreter interpreter;
+    m.millis = ElapsedMillis([&] { interpreter.run(program); });
+    m.result = interpreter.globals().get("result");
+    return m;
+}
+
+Measurement RunStack(const char *source) {
+    Measurement m;
+    auto ast = Parse(source);
+    suplang::Compiler compiler;
+    auto program = compiler.compile(ast.get());
+    suplang::VM vm;
+    m.millis = ElapsedMillis([&] { vm.run(program); });
+    m.instructions = vm.instructionCount();
+    m.result = vm.getGlobal("result");
+    return m;
+}
+
+Measurement RunRegister(const char *source) {
+    Measurement m;
+    auto ast = Parse(source);
+    suplang::RegisterCompiler compiler;
+    auto program = compiler.compile(ast.get());
+    suplang::RegisterVM vm;
+    m.millis = ElapsedMillis([&] { vm.run(program); });
+    m.instructions = vm.instructionCount();
+    m.result = vm.getGlobal("result");
+    return m;
+}
+
+std::string Describe(const suplang::Value &value) {
+    if (value.isInteger())
+        return std::to_string(value.asInteger());
+    return "null";
+}
+
+// Builds roughly `bytes` of source by repeating an indented function with
+// long names and numbers, so that every scanner sees realistic run lengths.
+std::string GenerateLexerSource(size_t bytes) {
+    const std::string chunk = R"(
+        accumulate_values = def accumulate_values(int32 number_of_iterations) {
+            int32 running_total_value = 0;
+            int32 loop_index_counter = 1234567;
+            while (loop_index_counter < number_of_iterations) {
+                running_total_value = running_total_value + loop_index_counter * 1000003;
+                loop_index_counter = loop_index_counter + 1;
+            }
+            return running_total_value;
+        };
+)";
+    std::string source;
+    source.reserve(bytes + chunk.size());
+    while (source.size() < bytes) {
+        source += chunk;
+    }
+    return source;
+}
+
+// Prints one throughput row: the median of `runs` and the MB/s it implies.
+void PrintThroughput(const char *name, std::vector<double> runs, size_t bytes, const std::string &count) {
+    std::sort(runs.begin(), runs.end());
+    double median = runs[runs.size() / 2];
+    double megabytes_per_second = (bytes / (1024.0 * 1024.0)) / (median / 1000.0);
+    std::cout << std::left << std::setw(10) << name << std::right << std::setw(12) << std::fixed << std::setprecision(2)
+              << median << std::setw(12) << megabytes_per_second << std::setw(13) << count << "\n";
+}
+
+void BenchmarkFrontEnd() {
+    const std::string source = GenerateLexerSource(8 << 20);
+    const suplang::ScanKernels *kernels[] = {&suplang::ScalarScanKernels(), suplang::Sse2ScanKernels(),
+                                             suplang::Avx2ScanKernels()};
+
+    std::cout << "\n" << std::left << std::setw(10) << "front end" << std::right << std::setw(12) << "median ms"
+              << std::setw(12) << "MB/s" << std::setw(14) << "tokens\n";
+    for (const suplang::ScanKernels *kernel : kernels) {
+        if (!kernel)
+            continue;
+        std::vector<double> runs;
+        size_t tokens = 0;
+        for (int i = 0; i < kRuns; ++i) {
+            tokens = 0;
+            runs.push_back(ElapsedMillis([&] {
+                suplang::Lexer lexer(source, *kernel);
+                while (lexer.nextToken().type != suplang::TokenType::END_OF_FILE) {
+                    ++tokens;
+                }
+            }));
+        }
+        PrintThroughput(kernel->name, runs, source.size(), std::to_string(tokens));
+    }
+
+    // A full parse with the default kernels, including freeing the tree.
+    std::vector<double> runs;
+    for (int i = 0; i < kRuns; ++i) {
+        runs.push_back(ElapsedMillis([&] {
+            suplang::Lexer lexer(source);
+            suplang::Parser parser(lexer);
+            parser.parseProgram();
+        }));
+    }
+    PrintThroughput("parse", runs, source.size(), "-");
+
+    // The script is all function definitions, so a lazy parse only matches
+    // their braces.
+    runs.clear();
+    for (int i = 0; i < kRuns; ++i) {
+        runs.push_back(ElapsedMillis([&] {
+            suplang::Lexer lexer(source);
+            suplang::Parser parser(lexer, true);
+            parser.parseProgram();
+        }));
+    }
+    PrintThroughput("lazy", runs, source.size(), "-");
+
+    // What a cached run does instead of parsing, hashing the source included.
+    suplang::Lexer lexer(source);
+    suplang::Parser parser(lexer);
+    std::string encoded = suplang::TreeCache::Encode(parser.parseProgram(), source, 0);
+    runs.clear();
+    for (int i = 0; i < kRuns; ++i) {
+        runs.push_back(ElapsedMillis([&] { suplang::TreeCache::Decode(encoded, source, 0); }));
+    }
+    PrintThroughput("cached", runs, source.size(), std::to_string(encoded.size()) + "B");
+}
+
+// Parses one program and runs many instances of it on 1 to N threads, all
+// sharing the tree.
+void BenchmarkSharedTree() {
+    const char *source = R"(
+        fib = def fib(int32 n) {
+            if (n < 2) { return n; }
+            return fib(n - 1) + fib(n - 2);
+        };
+        int32 result = fib(15);
+    )";
+    constexpr size_t kInstances = 1000;
+    auto ast = Parse(source);
+
+    std::cout << "\n" << std::left << std::setw(10) << "shared" << std::right << std::setw(12) << "threads"
+              << std::setw(12) << "median ms" << std::setw(12) << "runs/s" << std::setw(10) << "wrong\n";
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1;; threads = std::min(threads * 2, max_threads)) {
+        std::vector<double> runs;
+        size_t wrong = 0;
+        for (int i = 0; i < kRuns; ++i) {
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> mismatches{0};
+            runs.push_back(ElapsedMillis([&] {
+                std::vector<std::thread> pool;
+                for (unsigned t = 0; t < threads; ++t) {
+                    pool.emplace_back([&] {
+                        while (next.fetch_add(1) < kInstances) {
+                            suplang::Interpreter interpreter;
+                            interpreter.eval(ast.get());
+                            suplang::Value result = interpreter.globals().get("result");
+                            if (!result.isInteger() || result.asInteger() != 610)
+                                ++mismatches;
+                        }
+                    });
+                }
+                for (auto &thread : pool) {
+                    thread.join();
+                }
+            }));
+            wrong += mismatches;
+        }
+        std::sort(runs.begin(), runs.end());
+        double median = runs[runs.size() / 2];
+        std::cout << std::left << std::setw(10) << "fib(15)" << std::right << std::setw(12) << threads
+                  << std::setw(12) << std::fixed << std::setprecision(2) << median << std::setw(12)
+                  << std::setprecision(0) << kInstances / (median / 1000.0) << std::setw(9) << wrong << "\n";
+        if (threads == max_threads)
+            break;
+    }
+}
+
+} // namespace
+
+int main() {
+    struct Backend {
+        const char *name;
+        Measurement (*run)(const char *);
+    };
+    const Backend backends[] = {
+        {"ast", RunAst}, {"jit", RunJit}, {"closure", RunClosure}, {"stack", RunStack}, {"register", RunRegister}};
+
+    std::cout << std::left << std::setw(10) << "program" << std::setw(10) << "backend" << std::right << std::setw(12)
+              << "median ms" << std::setw(14) << "instructions" << "  result\n";
+    for (const auto &program : kPrograms) {
+        for (const auto &backend : backends) {
+            std::vector<Measurement> runs;
+            for (int i = 0; i < kRuns; ++i) {
+                runs.push_back(backend.run(program.source));
+            }
+            std::sort(runs.begin(), runs.end(),
+                      [](const Measurement &a, const Measurement &b) { return a.millis < b.millis; });
+            const Measurement &median = runs[kRuns / 2];
+            std::cout << std::left << std::setw(10) << program.name << std::setw(10) << backend.name << std::right
+                      << std::setw(12) << std::fixed << std::setprecision(2) << median.millis << std::setw(14)
+                      << (median.instructions ? std::to_string(median.instructions) : "-") << "  "
+                      << Describe(median.result) << "\n";
+        }
+    }
+
+    BenchmarkSharedTree();
+    BenchmarkFrontEnd();
+    return 0;
+}
@@ -1,9 +1,14 @@
 #ifndef SUPLANG_AST_ASTNODE_H_
 #define SUPLANG_AST_ASTNODE_H_
 
+#include "AST/Arena.h"
+#include "Lexer/Symbol.h"
+#include "Lexer/Token.h"
+
+#include <atomic>
+#include <cstdint>
 #include <memory>
-#include <string>
-#include <vector>
+#include <string_view>
 
 namespace suplang {
 
@@ -12,128 +17,309 @@ class ExpressionNode;
 class StatementNode;
 class BlockStatementNode;
 
+// The type an expression is certain to have at run time, as worked out by
+// the TypeChecker. DYNAMIC means it may hold anything, null included.
+enum class StaticType : uint8_t { DYNAMIC, INT32, BOOL, FUNCTION };
+
+constexpr const char *StaticTypeName(StaticType type) {
+    switch (type) {
+    case StaticType::INT32:
+        return "int32";
+    case StaticType::BOOL:
+        return "bool";
+    case StaticType::FUNCTION:
+        return "function";
+    case StaticType::DYNAMIC:
+        break;
+    }
+    return "dynamic";
+}
+
 // Represents a single typed parameter in a function definition.
 struct Parameter {
-    std::string type_name;
-    std::string param_name;
+    std::string_view type_name;
+    Symbol param_name;
+    // The declared type if it is one the TypeChecker enforces, set by it.
+    StaticType static_type = StaticType::DYNAMIC;
+};
+
+// How an identifier reaches its variable, as decided by the Resolver.
+enum class VariableKind : uint8_t {
+    UNBOUND, // Bound nowhere; reads give null.
+    LOCAL,   // A slot of the current environment: the call's, or the globals at the top level.
+    CELL,    // A slot of the call's environment holding the Cell of a captured variable.
+    UPVALUE, // A variable of an enclosing function, by index among the closure's upvalues.
+    GLOBAL,  // A top-level slot, used from inside a function.
+};
+
+// A variable a function literal captures when it is evaluated: the Cell in
+// a slot of the enclosing call, or one of the enclosing function's own
+// upvalues.
+struct UpvalueRef {
+    bool from_local;
+    size_t index; // The slot, or the enclosing function's upvalue index.
+};
+
+// Identifies the concrete type of an AST node. Every node class exposes its
+// kind as `kKind`, and passes dispatch on it with a switch instead of a chain
+// of dynamic_casts (see AST/NodeVisitor.h).
+enum class NodeKind : uint8_t {
+    PROGRAM,
+    BLOCK_STATEMENT,
+    EXPRESSION_STATEMENT,
+    VAR_DECL,
+    RETURN_STATEMENT,
+    IF_STATEMENT,
+    WHILE_STATEMENT,
+    INFIX_EXPRESSION,
+    PREFIX_EXPRESSION,
+    NUMBER_LITERAL,
+    BOOLEAN_LITERAL,
+    IDENTIFIER,
+    FUNCTION_LITERAL,
+    CALL_EXPRESSION,
 };
 
+// The operator of a prefix or infix expression, decided once by the parser.
+enum class Operator : uint8_t {
+    ASSIGN,    // =
+    ADD,       // +
+    SUBTRACT,  // -, also prefix negation
+    MULTIPLY,  // *
+    DIVIDE,    // /
+    LESS,      // <
+    GREATER,   // >
+    EQUAL,     // ==
+    NOT_EQUAL, // !=
+};
+
+// Returns the source spelling of `op`.
+constexpr const char *OperatorSpelling(Operator op) {
+    switch (op) {
+    case Operator::ASSIGN:
+        return "=";
+    case Operator::ADD:
+        return "+";
+    case Operator::SUBTRACT:
+        return "-";
+    case Operator::MULTIPLY:
+        return "*";
+    case Operator::DIVIDE:
+        return "/";
+    case Operator::LESS:
+        return "<";
+    case Operator::GREATER:
+        return ">";
+    case Operator::EQUAL:
+        return "==";
+    case Operator::NOT_EQUAL:
+        return "!=";
+    }
+    return "?";
+}
+
 // Base class for all nodes in the Abstract Syntax Tree (AST).
+//
+// Nodes are allocated in the Arena of their SyntaxTree and are never
+// destroyed one by one, so every node type is trivially destructible: child
+// nodes are plain pointers, child lists are ArenaArrays and strings are views
+// of arena memory.
 class ASTNode {
   public:
-    virtual ~ASTNode() = default;
+    explicit ASTNode(NodeKind kind) : kind(kind) {}
+    const NodeKind kind;
+    // Where the node's first token is, set by the Parser. Nodes made by later
+    // passes take the location of the node they replace.
+    SourceLocation location;
 };
 
 // Base class for all nodes that represent an expression.
-class ExpressionNode : public ASTNode {};
+class ExpressionNode : public ASTNode {
+  public:
+    explicit ExpressionNode(NodeKind kind) : ASTNode(kind) {}
+    // Set by the TypeChecker. An operator only gets a static type when both
+    // of its operands are int32.
+    StaticType static_type = StaticType::DYNAMIC;
+};
 
 // Base class for all nodes that represent a statement.
-class StatementNode : public ASTNode {};
+class StatementNode : public ASTNode {
+  public:
+    explicit StatementNode(NodeKind kind) : ASTNode(kind) {}
+};
+
+// Returns `node` as a `T` if it is one, or null otherwise. A tag comparison
+// that replaces dynamic_cast on AST nodes.
+template <typename T> T *NodeCast(ASTNode *node) {
+    return node && node->kind == T::kKind ? static_cast<T *>(node) : nullptr;
+}
+template <typename T> const T *NodeCast(const ASTNode *node) {
+    return node && node->kind == T::kKind ? static_cast<const T *>(node) : nullptr;
+}
 
 // Represents a `while` loop statement.
 class WhileStatementNode : public StatementNode {
   public:
-    WhileStatementNode(std::unique_ptr<ExpressionNode> cond, std::unique_ptr<BlockStatementNode> body)
-        : condition(std::move(cond)), body(std::move(body)) {}
+    static constexpr NodeKind kKind = NodeKind::WHILE_STATEMENT;
+    WhileStatementNode(ExpressionNode *cond, BlockStatementNode *body)
+        : StatementNode(kKind), condition(cond), body(body) {}
 
-    std::unique_ptr<ExpressionNode> condition;
-    std::unique_ptr<BlockStatementNode> body;
+    ExpressionNode *condition;
+    BlockStatementNode *body;
 };
 
 // Other existing node definitions...
 class FunctionLiteralNode : public ExpressionNode {
   public:
-    FunctionLiteralNode(std::vector<Parameter> params, std::unique_ptr<BlockStatementNode> body)
-        : parameters(std::move(params)), body(std::move(body)) {}
+    static constexpr NodeKind kKind = NodeKind::FUNCTION_LITERAL;
+    FunctionLiteralNode(ArenaArray<Parameter> params, BlockStatementNode *body)
+        : ExpressionNode(kKind), parameters(params), body(body) {}
+    // A function whose body the Parser skipped, to be parsed on first use by
+    // LazyFunctions. `body_offset` is the offset of its `{` in the source, and
+    // `body_location` its position.
+    FunctionLiteralNode(ArenaArray<Parameter> params, size_t body_offset, SourceLocation body_location)
+        : ExpressionNode(kKind), parameters(params), body(nullptr), body_offset(body_offset),
+          body_location(body_location), deferred(true) {}
 
-    std::vector<Parameter> parameters;
-    std::unique_ptr<BlockStatementNode> body;
+    Symbol name = kNoSymbol; // The name after `def`.
+    ArenaArray<Parameter> parameters;
+    BlockStatementNode *body;
+    size_t body_offset = 0;
+    SourceLocation body_location;
+    // Whether the body is still unparsed. Cleared, with release ordering,
+    // once the body is parsed and every pass below has run on it.
+    std::atomic<bool> deferred{false};
+    bool isDeferred() const { return deferred.load(std::memory_order_acquire); }
+    // Set by the Resolver: the size of a call's environment (parameters
+    // first), the slots whose variables nested functions capture, and the
+    // variables of enclosing functions this one captures.
+    size_t num_locals = 0;
+    ArenaArray<size_t> captured_slots;
+    ArenaArray<UpvalueRef> upvalues;
 };
 
 class CallExpressionNode : public ExpressionNode {
   public:
-    CallExpressionNode(std::unique_ptr<ExpressionNode> func, std::vector<std::unique_ptr<ExpressionNode>> args)
-        : function(std::move(func)), arguments(std::move(args)) {}
+    static constexpr NodeKind kKind = NodeKind::CALL_EXPRESSION;
+    CallExpressionNode(ExpressionNode *func, ArenaArray<ExpressionNode *> args)
+        : ExpressionNode(kKind), function(func), arguments(args) {}
 
-    std::unique_ptr<ExpressionNode> function;
-    std::vector<std::unique_ptr<ExpressionNode>> arguments;
+    ExpressionNode *function;
+    ArenaArray<ExpressionNode *> arguments;
 };
 
 class ReturnStatementNode : public StatementNode {
   public:
-    explicit ReturnStatementNode(std::unique_ptr<ExpressionNode> val) : return_value(std::move(val)) {}
-    std::unique_ptr<ExpressionNode> return_value;
+    static constexpr NodeKind kKind = NodeKind::RETURN_STATEMENT;
+    explicit ReturnStatementNode(ExpressionNode *val) : StatementNode(kKind), return_value(val) {}
+    ExpressionNode *return_value;
 };
 
 class NumberLiteralNode : public ExpressionNode {
   public:
-    explicit NumberLiteralNode(int32_t val) : value(val) {}
+    static constexpr NodeKind kKind = NodeKind::NUMBER_LITERAL;
+    explicit NumberLiteralNode(int32_t val) : ExpressionNode(kKind), value(val) {}
     int32_t value;
 };
 
 class BooleanLiteralNode : public ExpressionNode {
   public:
-    explicit BooleanLiteralNode(bool val) : value(val) {}
+    static constexpr NodeKind kKind = NodeKind::BOOLEAN_LITERAL;
+    explicit BooleanLiteralNode(bool val) : ExpressionNode(kKind), value(val) {}
     bool value;
 };
 
 class IdentifierNode : public ExpressionNode {
   public:
-    explicit IdentifierNode(const std::string &val) : value(val) {}
-    std::string value;
+    static constexpr NodeKind kKind = NodeKind::IDENTIFIER;
+    explicit IdentifierNode(Symbol symbol) : ExpressionNode(kKind), symbol(symbol) {}
+    Symbol symbol;
+    // Set by the Resolver: how the variable is reached, and its slot or
+    // upvalue index.
+    VariableKind variable = VariableKind::UNBOUND;
+    size_t slot = 0;
 };
 
 class PrefixExpressionNode : public ExpressionNode {
   public:
-    PrefixExpressionNode(const std::string &op, std::unique_ptr<ExpressionNode> right)
-        : op(op), right(std::move(right)) {}
-    std::string op;
-    std::unique_ptr<ExpressionNode> right;
+    static constexpr NodeKind kKind = NodeKind::PREFIX_EXPRESSION;
+    PrefixExpressionNode(Operator op, ExpressionNode *right) : ExpressionNode(kKind), op(op), right(right) {}
+    Operator op;
+    ExpressionNode *right;
 };
 
 class InfixExpressionNode : public ExpressionNode {
   public:
-    InfixExpressionNode(std::unique_ptr<ExpressionNode> left, const std::string &op,
-                        std::unique_ptr<ExpressionNode> right)
-        : left(std::move(left)), op(op), right(std::move(right)) {}
-    std::unique_ptr<ExpressionNode> left;
-    std::string op;
-    std::unique_ptr<ExpressionNode> right;
+    static constexpr NodeKind kKind = NodeKind::INFIX_EXPRESSION;
+    InfixExpressionNode(ExpressionNode *left, Operator op, ExpressionNode *right)
+        : ExpressionNode(kKind), left(left), op(op), right(right) {}
+    ExpressionNode *left;
+    Operator op;
+    ExpressionNode *right;
 };
 
 class ExpressionStatementNode : public StatementNode {
   public:
-    explicit ExpressionStatementNode(std::unique_ptr<ExpressionNode> expr) : expression(std::move(expr)) {}
-    std::unique_ptr<ExpressionNode> expression;
+    static constexpr NodeKind kKind = NodeKind::EXPRESSION_STATEMENT;
+    explicit ExpressionStatementNode(ExpressionNode *expr) : StatementNode(kKind), expression(expr) {}
+    ExpressionNode *expression;
 };
 
 class BlockStatementNode : public StatementNode {
   public:
-    std::vector<std::unique_ptr<StatementNode>> statements;
+    static constexpr NodeKind kKind = NodeKind::BLOCK_STATEMENT;
+    explicit BlockStatementNode(ArenaArray<StatementNode *> statements)
+        : StatementNode(kKind), statements(statements) {}
+
+    ArenaArray<StatementNode *> statements;
 };
 
 class IfStatementNode : public StatementNode {
   public:
-    IfStatementNode(std::unique_ptr<ExpressionNode> cond, std::unique_ptr<BlockStatementNode> cons,
-                    std::unique_ptr<StatementNode> alt)
-        : condition(std::move(cond)), consequence(std::move(cons)), alternative(std::move(alt)) {}
-    std::unique_ptr<ExpressionNode> condition;
-    std::unique_ptr<BlockStatementNode> consequence;
-    std::unique_ptr<StatementNode> alternative;
+    static constexpr NodeKind kKind = NodeKind::IF_STATEMENT;
+    IfStatementNode(ExpressionNode *cond, BlockStatementNode *cons, StatementNode *alt)
+        : StatementNode(kKind), condition(cond), consequence(cons), alternative(alt) {}
+    ExpressionNode *condition;
+    BlockStatementNode *consequence;
+    StatementNode *alternative;
 };
 
 class VarDeclNode : public StatementNode {
   public:
-    VarDeclNode(const std::string &type, const std::string &name, std::unique_ptr<ExpressionNode> value)
-        : varType(type), varName(name), initialValue(std::move(value)) {}
-    std::string varType;
-    std::string varName;
-    std::unique_ptr<ExpressionNode> initialValue;
+    static constexpr NodeKind kKind = NodeKind::VAR_DECL;
+    VarDeclNode(std::string_view type, Symbol name, ExpressionNode *value)
+        : StatementNode(kKind), varType(type), varName(name), initialValue(value) {}
+    std::string_view varType;
+    Symbol varName;
+    ExpressionNode *initialValue;
+    size_t slot = 0; // Slot in the current environment, set by the Resolver.
+    bool captured = false; // The slot holds a Cell, set by the Resolver.
 };
 
 class ProgramNode : public ASTNode {
   public:
-    std::vector<std::unique_ptr<StatementNode>> statements;
+    static constexpr NodeKind kKind = NodeKind::PROGRAM;
+    explicit ProgramNode(ArenaArray<StatementNode *> statements) : ASTNode(kKind), statements(statements) {}
+
+    ArenaArray<StatementNode *> statements;
+    size_t num_locals = 0; // Size of the global environment, set by the Resolver.
+};
+
+// A parsed program: its root node together with the arena holding every node,
+// child list and string of the tree. Destroying it frees the whole tree at
+// once. Anything that points into the tree, such as an interpreted function
+// value, must not outlive it.
+class SyntaxTree {
+  public:
+    SyntaxTree(std::unique_ptr<Arena> arena, ProgramNode *root) : arena_(std::move(arena)), root_(root) {}
+
+    ProgramNode *get() const { return root_; }
+    ProgramNode *operator->() const { return root_; }
+    Arena &arena() const { return *arena_; }
+
+  private:
+    std::unique_ptr<Arena> arena_;
+    ProgramNode *root_;
 };
 
 } // namespace suplang
@@ -0,0 +1,111 @@
+#ifndef SUPLANG_AST_ARENA_H_
+#define SUPLANG_AST_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace suplang {
+
+// A fixed-size array whose elements live in an Arena. It is a plain view, so
+// it is trivially destructible and can itself be stored in arena objects.
+template <typename T> class ArenaArray {
+  public:
+    ArenaArray() = default;
+    ArenaArray(T *data, size_t size) : data_(data), size_(size) {}
+
+    T *begin() const { return data_; }
+    T *end() const { return data_ + size_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T &operator[](size_t index) const { return data_[index]; }
+    T &back() const { return data_[size_ - 1]; }
+
+  private:
+    T *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// A bump allocator. Objects are carved out of large blocks one after another
+// and are never destroyed individually: the whole arena is released at once
+// when it is destroyed. Only trivially destructible types may be placed in
+// it, so skipping their destructors is safe.
+class Arena {
+  public:
+    Arena() = default;
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    // Returns `size` bytes aligned to `align`, valid until the arena dies.
+    void *allocate(size_t size, size_t align) {
+        size_t padding = (align - reinterpret_cast<uintptr_t>(cursor_) % align) % align;
+        if (static_cast<size_t>(limit_ - cursor_) < size + padding) {
+            return allocateSlow(size, align);
+        }
+        void *result = cursor_ + padding;
+        cursor_ += size + padding;
+        return result;
+    }
+
+    // Constructs a T in the arena.
+    template <typename T, typename... Args> T *make(Args &&...args) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Copies `elements` into the arena.
+    template <typename T> ArenaArray<T> copyArray(const std::vector<T> &elements) {
+        static_assert(std::is_trivially_copyable<T>::value, "arena arrays hold plain values");
+        if (elements.empty())
+            return {};
+        T *data = static_cast<T *>(allocate(sizeof(T) * elements.size(), alignof(T)));
+        std::memcpy(data, elements.data(), sizeof(T) * elements.size());
+        return {data, elements.size()};
+    }
+
+    // Copies `text` into the arena.
+    std::string_view copyString(std::string_view text) {
+        if (text.empty())
+            return {};
+        char *data = static_cast<char *>(allocate(text.size(), 1));
+        std::memcpy(data, text.data(), text.size());
+        return {data, text.size()};
+    }
+
+    // Total bytes reserved from the system.
+    size_t bytesReserved() const { return bytes_reserved_; }
+
+  private:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    void *allocateSlow(size_t size, size_t align) {
+        // Oversized requests get a block of their own, so the current block
+        // keeps serving small ones.
+        size_t block_size = size + align > kBlockSize / 4 ? size + align : kBlockSize;
+        blocks_.push_back(std::unique_ptr<char[]>(new char[block_size]));
+        bytes_reserved_ += block_size;
+        char *block = blocks_.back().get();
+        if (block_size == kBlockSize) {
+            cursor_ = block;
+            limit_ = block + block_size;
+            return allocate(size, align);
+        }
+        size_t padding = (align - reinterpret_cast<uintptr_t>(block) % align) % align;
+        return block + padding;
+    }
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char *cursor_ = nullptr;
+    char *limit_ = nullptr;
+    size_t bytes_reserved_ = 0;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_AST_ARENA_H_
@@ -0,0 +1,65 @@
+#ifndef SUPLANG_AST_NODEVISITOR_H_
+#define SUPLANG_AST_NODEVISITOR_H_
+
+#include "AST/ASTNode.h"
+
+#include <type_traits>
+
+namespace suplang {
+
+// Combines several lambdas into one overloaded callable, so a visitor can be
+// written inline as one lambda per node type.
+template <typename... Fs> struct Overloaded : Fs... {
+    using Fs::operator()...;
+};
+template <typename... Fs> Overloaded(Fs...) -> Overloaded<Fs...>;
+
+namespace detail {
+// Downcasts `node` to `T`, keeping the constness of `Node`.
+template <typename T, typename Node> auto NodeAs(Node *node) {
+    using Target = std::conditional_t<std::is_const<Node>::value, const T, T>;
+    return static_cast<Target *>(node);
+}
+} // namespace detail
+
+// Calls `visitor` with `node` downcast to its concrete type, selected by a
+// single switch on the node's kind. Works on both mutable and const nodes;
+// every overload must return something convertible to `Result`.
+template <typename Result, typename Node, typename Visitor> Result VisitNode(Node *node, Visitor &&visitor) {
+    static_assert(std::is_base_of<ASTNode, std::remove_const_t<Node>>::value, "VisitNode expects an AST node");
+    switch (node->kind) {
+    case NodeKind::PROGRAM:
+        return visitor(detail::NodeAs<ProgramNode>(node));
+    case NodeKind::BLOCK_STATEMENT:
+        return visitor(detail::NodeAs<BlockStatementNode>(node));
+    case NodeKind::EXPRESSION_STATEMENT:
+        return visitor(detail::NodeAs<ExpressionStatementNode>(node));
+    case NodeKind::VAR_DECL:
+        return visitor(detail::NodeAs<VarDeclNode>(node));
+    case NodeKind::RETURN_STATEMENT:
+        return visitor(detail::NodeAs<ReturnStatementNode>(node));
+    case NodeKind::IF_STATEMENT:
+        return visitor(detail::NodeAs<IfStatementNode>(node));
+    case NodeKind::WHILE_STATEMENT:
+        return visitor(detail::NodeAs<WhileStatementNode>(node));
+    case NodeKind::INFIX_EXPRESSION:
+        return visitor(detail::NodeAs<InfixExpressionNode>(node));
+    case NodeKind::PREFIX_EXPRESSION:
+        return visitor(detail::NodeAs<PrefixExpressionNode>(node));
+    case NodeKind::NUMBER_LITERAL:
+        return visitor(detail::NodeAs<NumberLiteralNode>(node));
+    case NodeKind::BOOLEAN_LITERAL:
+        return visitor(detail::NodeAs<BooleanLiteralNode>(node));
+    case NodeKind::IDENTIFIER:
+        return visitor(detail::NodeAs<IdentifierNode>(node));
+    case NodeKind::FUNCTION_LITERAL:
+        return visitor(detail::NodeAs<FunctionLiteralNode>(node));
+    case NodeKind::CALL_EXPRESSION:
+        return visitor(detail::NodeAs<CallExpressionNode>(node));
+    }
+    return visitor(detail::NodeAs<ProgramNode>(node)); // Not reached: the switch covers every kind.
+}
+
+} // namespace suplang
+
+#endif // SUPLANG_AST_NODEVISITOR_H_
@@ -0,0 +1,49 @@
+#ifndef SUPLANG_AST_TREECACHE_H_
+#define SUPLANG_AST_TREECACHE_H_
+
+#include "AST/ASTNode.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace suplang {
+
+// How a cached tree was produced. A tree is only reused by a run that would
+// have produced it the same way.
+constexpr uint32_t kTreeFolded = 1;         // The ConstantFolder has run on it.
+constexpr uint32_t kTreeDeferredBodies = 2; // Top-level function bodies were left unparsed.
+
+// Stores parsed programs on disk, so that a run of an unchanged script skips
+// the lexer and the parser. The file is a compact binary encoding of the
+// tree, keyed by a hash of the source text, its size, the flags and the
+// format version; any mismatch, or a damaged file, is a miss.
+//
+// Symbols are process-specific, so the file names every identifier once and
+// nodes refer to them by index. Loading maps the file and decodes it straight
+// into the tree's arena, interning each name once. The annotations of later
+// passes, such as the Resolver's, are not stored.
+class TreeCache {
+  public:
+    // Bumped whenever the encoding, or anything it records, changes.
+    static constexpr uint32_t kFormatVersion = 2;
+
+    // The cache file of the script at `script_path`.
+    static std::string PathFor(const std::string &script_path) { return script_path + ".cache"; }
+
+    // Returns the tree cached at `path` for `source`, or null on a miss.
+    static std::unique_ptr<SyntaxTree> Load(const std::string &path, std::string_view source, uint32_t flags);
+    // Caches `tree`, parsed from `source`, at `path`. The file is replaced
+    // atomically, so concurrent runs never see it half written. Returns false
+    // if it cannot be written.
+    static bool Store(const std::string &path, std::string_view source, uint32_t flags, const SyntaxTree &tree);
+
+    // The in-memory forms of Load and Store.
+    static std::unique_ptr<SyntaxTree> Decode(std::string_view data, std::string_view source, uint32_t flags);
+    static std::string Encode(const SyntaxTree &tree, std::string_view source, uint32_t flags);
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_AST_TREECACHE_H_
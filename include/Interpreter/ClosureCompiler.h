@@ -0,0 +1,78 @@
+#ifndef SUPLANG_INTERPRETER_CLOSURECOMPILER_H_
+#define SUPLANG_INTERPRETER_CLOSURECOMPILER_H_
+
+#include "AST/ASTNode.h"
+#include "Interpreter/Environment.h"
+#include "Object/Object.h"
+#include "Object/Value.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace suplang {
+
+class ClosureInterpreter;
+
+// A compiled AST node: evaluates the node with `locals` as the slots of the
+// current call (or the globals at the top level). Everything the tree
+// walker would work out on each visit (the node's kind, its operator, the
+// address of a variable) is decided once, when the closure is built.
+using Closure = std::function<Value(ClosureInterpreter &interpreter, Value *locals)>;
+
+// The compiled form of a function literal.
+struct ClosureFunction {
+    size_t arity = 0;
+    size_t num_locals = 0; // Slots of a call's environment.
+    std::vector<size_t> captured_slots; // Slots of a call that hold Cells.
+    std::vector<UpvalueRef> upvalues;   // What a new closure captures.
+    Closure body;
+};
+
+// The result of compiling a whole program to closures. It owns the code of
+// every function, so it must outlive the values created by running it.
+struct ClosureProgram {
+    Closure script;
+    // Names of the top-level slots, indexed by slot.
+    std::vector<Symbol> global_names;
+    std::vector<std::unique_ptr<ClosureFunction>> functions;
+};
+
+// Represents a closure-compiled function at runtime.
+class ClosureFunctionObject : public Object {
+  public:
+    explicit ClosureFunctionObject(const ClosureFunction *function) : function(function) {
+        type = ObjectType::CLOSURE_FUNCTION;
+    }
+    const ClosureFunction *function;
+    Upvalues upvalues; // The captured variables, kept alive by the collector.
+};
+
+// The ClosureCompiler turns a program into a tree of closures for the
+// ClosureInterpreter. It reads the variable addresses the Resolver recorded
+// in the tree, exactly as the Interpreter does, and the two produce the same
+// results.
+class ClosureCompiler {
+  public:
+    ClosureProgram compile(ProgramNode *program);
+
+  private:
+    Closure compileNode(ASTNode *node);
+    Closure compileBlock(const ArenaArray<StatementNode *> &statements);
+    Closure compileVarDecl(VarDeclNode *node);
+    Closure compileReturnStatement(ReturnStatementNode *node);
+    Closure compileIfStatement(IfStatementNode *node);
+    Closure compileWhileStatement(WhileStatementNode *node);
+    Closure compileInfixExpression(InfixExpressionNode *node);
+    Closure compilePrefixExpression(PrefixExpressionNode *node);
+    Closure compileIdentifier(IdentifierNode *node);
+    Closure compileFunctionLiteral(FunctionLiteralNode *node);
+    Closure compileCallExpression(CallExpressionNode *node);
+
+    ClosureProgram *program_ = nullptr;
+    int function_depth_ = 0; // Function literals enclosing the current node.
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_INTERPRETER_CLOSURECOMPILER_H_
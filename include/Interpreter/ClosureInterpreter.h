@@ -0,0 +1,69 @@
+#ifndef SUPLANG_INTERPRETER_CLOSUREINTERPRETER_H_
+#define SUPLANG_INTERPRETER_CLOSUREINTERPRETER_H_
+
+#include "Interpreter/ClosureCompiler.h"
+#include "Interpreter/Environment.h"
+#include "Interpreter/ValueStack.h"
+#include "Object/Heap.h"
+#include "Object/Value.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace suplang {
+
+// Runs programs built by the ClosureCompiler. It keeps the same runtime
+// state as the Interpreter (a collected heap, the global environment, a value
+// stack with the slots of active calls and the temporaries the collector must
+// see),
+// and the compiled closures manipulate it directly.
+class ClosureInterpreter {
+  public:
+    explicit ClosureInterpreter(GcOptions gc_options = {});
+
+    // Runs `program` in the global environment and returns the completion
+    // value of its last statement. A returned object stays valid only until
+    // the next call to `run`.
+    Value run(const ClosureProgram &program);
+
+    // The top-level environment, to look variables up after a run.
+    const Environment &globals() const { return *globals_; }
+    const Heap &heap() const { return heap_; }
+
+  private:
+    // The compiled closures are built by the ClosureCompiler and use the
+    // helpers and state below.
+    friend class ClosureCompiler;
+
+    // Pushes the callee and the arguments of a call onto `temps_`. Returns
+    // false, pushing nothing, if the callee is null.
+    bool pushCall(const Closure &function, const std::vector<Closure> &arguments, Value *locals);
+    // Applies the function at `temps_[callee]` to the `argc` values that
+    // follow it, along with any tail calls its body makes.
+    Value applyFunction(size_t callee, size_t argc);
+
+    void markRoots(Heap &heap);
+
+    Heap heap_;
+    Environment *globals_;
+    ValueStack stack_;
+    // A call in progress: its slots on `stack_`, and the function whose
+    // upvalues its body reads.
+    struct Frame {
+        Value *locals;
+        size_t size;
+        ClosureFunctionObject *function;
+    };
+    std::vector<Frame> frames_;
+    std::vector<Value> temps_; // Values held across an evaluation that may allocate.
+    // Set by a return statement and cleared by the call (or program) it
+    // leaves; while set, blocks and loops stop and pass their value up.
+    bool returning_ = false;
+    // Index in `temps_` of the callee of a pending tail call.
+    static constexpr size_t kNoTailCall = static_cast<size_t>(-1);
+    size_t tail_call_ = kNoTailCall;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_INTERPRETER_CLOSUREINTERPRETER_H_
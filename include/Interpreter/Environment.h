@@ -1,35 +1,47 @@
 #ifndef SUPLANG_INTERPRETER_ENVIRONMENT_H_
 #define SUPLANG_INTERPRETER_ENVIRONMENT_H_
 
-#include <map>
-#include <memory>
+#include "Lexer/Symbol.h"
+#include "Object/Object.h"
+#include "Object/SlabPool.h"
+#include "Object/Value.h"
+
 #include <string>
+#include <vector>
 
 namespace suplang {
 
-// Forward declaration to break the circular dependency with Object.h.
-class Object;
-
-// Represents a scope for storing variables and their values during runtime.
-// Supports nesting to create local scopes for functions.
-class Environment {
+// Holds the global variables during runtime. They live in a flat array of
+// slots whose layout is decided ahead of time by the Resolver; the locals of
+// calls live on the interpreter's ValueStack instead. The environment is a
+// heap object, and its slots come from the slab pool like the environment
+// itself.
+class Environment : public Object {
   public:
-    Environment() = default;
-    // Creates a new, enclosed environment for a function call.
-    explicit Environment(std::shared_ptr<Environment> outer) : outer_(outer) {}
+    Environment() { type = ObjectType::ENVIRONMENT; }
+
+    // Lays out a top-level environment with one null slot per name, so that
+    // the host can look variables up by name after a run.
+    void declare(const std::vector<Symbol> &names);
+
+    const Value &get(size_t slot) const { return slots_[slot]; }
+    void set(size_t slot, Value value) { slots_[slot] = value; }
+    // The slots, which keep their address until the next `declare`.
+    Value *data() { return slots_.data(); }
 
-    // Retrieves an object by name. If not found in the current scope, it
-    // recursively searches in the outer scope.
-    std::shared_ptr<Object> get(const std::string &name);
+    // Retrieves a value by name from a declared top-level environment, or
+    // null if the name has no slot.
+    Value get(const std::string &name) const;
 
-    // Stores an object with a given name in the current scope.
-    void set(const std::string &name, std::shared_ptr<Object> value);
+    // Accessors for the garbage collector.
+    const std::vector<Value, SlabAllocator<Value>> &slots() const { return slots_; }
+    size_t slotCount() const { return slots_.capacity(); }
 
   private:
-    std::map<std::string, std::shared_ptr<Object>> store_;
-    std::shared_ptr<Environment> outer_ = nullptr;
+    std::vector<Value, SlabAllocator<Value>> slots_;
+    std::vector<Symbol> names_;
 };
 
 } // namespace suplang
 
-#endif // SUPLANG_INTERPRETER_ENVIRONMENT_H_
\ No newline at end of file
+#endif // SUPLANG_INTERPRETER_ENVIRONMENT_H_
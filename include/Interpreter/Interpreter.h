@@ -3,40 +3,131 @@
 
 #include "AST/ASTNode.h"
 #include "Interpreter/Environment.h"
+#include "Interpreter/LazyFunctions.h"
+#include "Interpreter/Profiler.h"
+#include "Interpreter/ValueStack.h"
+#include "Jit/Jit.h"
+#include "Object/Heap.h"
+#include "Object/Value.h"
 
+#include <cstddef>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace suplang {
 
 // Forward declarations to break include cycles. The full definitions will be
 // included in the corresponding .cpp file.
-class Object;
 class FunctionObject;
 
-// The Interpreter class traverses the AST and evaluates it.
+// The Interpreter class traverses the AST and evaluates it. Functions, the
+// globals and captured variables live in the interpreter's garbage-collected
+// heap; the locals of each call live on its value stack. Every evaluation
+// method takes the slots of the current call (or the globals at the top
+// level) as `locals`.
+//
+// Evaluation never modifies the tree: function values borrow their bodies
+// from it, and all per-run state lives in the interpreter. Interpreters on
+// different threads can therefore run the same tree at once, each with its
+// own heap and stack.
 class Interpreter {
   public:
-    std::shared_ptr<Object> eval(ASTNode *node, std::shared_ptr<Environment> env);
+    explicit Interpreter(GcOptions gc_options = {});
+
+    // Evaluates `node` in the global environment. The tree must have been
+    // resolved beforehand by the Resolver.
+    // A returned object stays valid only until the next call to `eval`.
+    Value eval(const ASTNode *node);
+
+    // The top-level environment, to look variables up after a run.
+    const Environment &globals() const { return *globals_; }
+    const Heap &heap() const { return heap_; }
+
+    // Compiles the functions the JitCompiler accepts to native code as they
+    // are defined, and runs their calls natively whenever the arguments have
+    // the declared types. Every other call is interpreted.
+    void enableJit() { jit_enabled_ = true; }
+
+    // Loads the deferred function bodies of a lazily parsed tree when they
+    // are first called. `lazy_functions` must outlive the runs.
+    void setLazyFunctions(LazyFunctions *lazy_functions) { lazy_functions_ = lazy_functions; }
+    // Whether the last run stopped early because the body of a function it
+    // called failed to load.
+    bool halted() const { return halted_; }
+
+    // Reports every call and statement run to `profiler`, which must outlive
+    // the runs. Null, the default, turns profiling off.
+    void setProfiler(Profiler *profiler) { profiler_ = profiler; }
 
   private:
+    Value eval(const ASTNode *node, Value *locals);
+
     // Methods for evaluating specific AST node types.
-    std::shared_ptr<Object> evalProgram(ProgramNode *node, std::shared_ptr<Environment> env);
-    std::shared_ptr<Object> evalBlockStatement(BlockStatementNode *node, std::shared_ptr<Environment> env);
-    std::shared_ptr<Object> evalVarDecl(VarDeclNode *node, std::shared_ptr<Environment> env);
-    std::shared_ptr<Object> evalIfStatement(IfStatementNode *node, std::shared_ptr<Environment> env);
-    std::shared_ptr<Object> evalWhileStatement(WhileStatementNode *node, std::shared_ptr<Environment> env);
-    std::shared_ptr<Object> evalPrefixExpression(PrefixExpressionNode *node, std::shared_ptr<Environment> env);
-    std::shared_ptr<Object> evalReturnStatement(ReturnStatementNode *node, std::shared_ptr<Environment> env);
-    std::shared_ptr<Object> evalInfixExpression(InfixExpressionNode *node, std::shared_ptr<Environment> env);
-
-    // Helper for applying a function.
-    std::shared_ptr<Object> applyFunction(std::shared_ptr<Object> fn, const std::vector<std::shared_ptr<Object>> &args);
-    // Helper for creating a function's local environment.
-    std::shared_ptr<Environment> extendFunctionEnv(FunctionObject *fn,
-                                                   const std::vector<std::shared_ptr<Object>> &args);
+    Value evalProgram(const ProgramNode *node);
+    Value evalBlockStatement(const BlockStatementNode *node, Value *locals);
+    Value evalVarDecl(const VarDeclNode *node, Value *locals);
+    Value evalIfStatement(const IfStatementNode *node, Value *locals);
+    Value evalWhileStatement(const WhileStatementNode *node, Value *locals);
+    Value evalIdentifier(const IdentifierNode *node, Value *locals);
+    Value evalFunctionLiteral(const FunctionLiteralNode *node, Value *locals);
+    Value evalPrefixExpression(const PrefixExpressionNode *node, Value *locals);
+    Value evalReturnStatement(const ReturnStatementNode *node, Value *locals);
+    Value evalInfixExpression(const InfixExpressionNode *node, Value *locals);
+    // Evaluates an operator the TypeChecker proved to have int32 operands.
+    Value evalIntegerInfix(const InfixExpressionNode *node, Value *locals);
+    // Evaluates an expression whose static type is int32.
+    int32_t evalInteger(const ExpressionNode *node, Value *locals);
+    Value evalCallExpression(const CallExpressionNode *node, Value *locals);
+
+    // Pushes the callee and the arguments of `node` onto `temps_`. Returns
+    // false, pushing nothing, if the callee is null.
+    bool pushCall(const CallExpressionNode *node, Value *locals);
+    // Helper for applying the function at `temps_[callee]` to the `argc`
+    // values that follow it, along with any tail calls its body makes.
+    Value applyFunction(size_t callee, size_t argc);
+    // Returns the native code of `node`, compiling it on first use, or null
+    // if the JIT does not support it.
+    const JitFunction *jitFunction(const FunctionLiteralNode *node);
+
+    // Reports the global environment, the active calls and the temporaries
+    // to the collector.
+    void markRoots(Heap &heap);
+
+    Heap heap_;
+    Environment *globals_;
+    ValueStack stack_;
+    // A call in progress: its slots on `stack_`, and the function whose
+    // upvalues its body reads.
+    struct Frame {
+        Value *locals;
+        size_t size;
+        FunctionObject *function;
+    };
+    std::vector<Frame> frames_;
+    std::vector<Value> temps_; // Values held across an evaluation that may allocate.
+    // Set by a return statement and cleared by the call (or program) it
+    // leaves; while set, blocks and loops stop and pass their value up.
+    bool returning_ = false;
+    // Index in `temps_` of the callee of a pending tail call, set together
+    // with `returning_` by `return f(...)`.
+    static constexpr size_t kNoTailCall = static_cast<size_t>(-1);
+    size_t tail_call_ = kNoTailCall;
+    // Set when a function body fails to load. The run then unwinds as from
+    // a return that no call consumes, making no further calls.
+    bool halted_ = false;
+    // Whether the static types of the code being run hold: always at the top
+    // level, and in a call whose arguments have their declared types.
+    bool typed_ = true;
+
+    LazyFunctions *lazy_functions_ = nullptr;
+    Profiler *profiler_ = nullptr;
+    bool jit_enabled_ = false;
+    // Native code by function literal, null for those the JIT rejected. Like
+    // the function values, it assumes the trees outlive the interpreter.
+    std::unordered_map<const FunctionLiteralNode *, std::unique_ptr<JitFunction>> jit_code_;
 };
 
 } // namespace suplang
 
-#endif // SUPLANG_INTERPRETER_INTERPRETER_H_
\ No newline at end of file
+#endif // SUPLANG_INTERPRETER_INTERPRETER_H_
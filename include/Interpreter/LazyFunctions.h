@@ -0,0 +1,46 @@
+#ifndef SUPLANG_INTERPRETER_LAZYFUNCTIONS_H_
+#define SUPLANG_INTERPRETER_LAZYFUNCTIONS_H_
+
+#include "AST/ASTNode.h"
+
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace suplang {
+
+// Parses the function bodies a Parser deferred, the first time each function
+// is called, so that start-up only pays for the code that runs. A body goes
+// through the same passes as the rest of the tree: constant folding, the
+// Resolver and the TypeChecker. Parse and type errors in it are only found
+// then, so a body that is never called is never checked.
+//
+// Loading is the only change made to a tree while it is being run, so it is
+// serialized: interpreters on several threads may share the tree and one
+// LazyFunctions.
+class LazyFunctions {
+  public:
+    // `source` is the text `tree` was parsed from, and `globals` the names of
+    // its top-level slots, as returned by the Resolver. The source and the
+    // tree must outlive this.
+    LazyFunctions(std::string_view source, SyntaxTree &tree, std::vector<Symbol> globals)
+        : source_(source), tree_(tree), globals_(std::move(globals)) {}
+
+    // Parses the body of `function` and runs the passes on it, unless that
+    // has been done. Returns false, having reported the errors, if the body
+    // does not parse or type-check; it then stays deferred, and loading it
+    // again fails without reporting them twice.
+    bool load(const FunctionLiteralNode *function);
+
+  private:
+    std::string_view source_;
+    SyntaxTree &tree_;
+    std::vector<Symbol> globals_;
+    std::mutex mutex_;
+    std::unordered_set<const FunctionLiteralNode *> failed_;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_INTERPRETER_LAZYFUNCTIONS_H_
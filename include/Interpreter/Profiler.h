@@ -0,0 +1,82 @@
+#ifndef SUPLANG_INTERPRETER_PROFILER_H_
+#define SUPLANG_INTERPRETER_PROFILER_H_
+
+#include "AST/ASTNode.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace suplang {
+
+// Attributes the wall time of a run to the calls and statements it is spent
+// in. The Interpreter reports every call and every statement of a block as
+// it starts and ends, and the time between two such events is charged to
+// the innermost statement of the innermost call. The times recorded are
+// therefore self times, and they add up to the whole run.
+//
+// Calls are told apart by stack: the profiler keeps the tree of the call
+// paths taken from the program down, as a sampling profiler would, but with
+// exact times and call counts. Native code run by the JIT makes no calls of
+// its own, so its time is the calling function's.
+//
+// A profiler serves one interpreter and is not thread safe.
+class Profiler {
+  public:
+    // Starts the clock.
+    Profiler();
+
+    // Called by the Interpreter.
+    void enterFunction(const FunctionLiteralNode *function);
+    void leaveFunction();
+    void enterStatement(const StatementNode *statement);
+    void leaveStatement();
+
+    // Writes the times in the collapsed stack format of flamegraph tools: one
+    // line per stack, its frames from the program down separated by ';',
+    // then a space and the nanoseconds spent there. A statement is the last
+    // frame of the time spent in it.
+    void writeCollapsed(std::ostream &out) const;
+    // Writes tables of the functions and of the statements taking the most
+    // time, at most `limit` rows each.
+    void writeReport(std::ostream &out, size_t limit = 20) const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Time {
+        uint64_t nanoseconds = 0;
+        uint64_t count = 0; // Calls or executions.
+    };
+    // A call path: the program, or a call of `function` from the `parent` path.
+    struct Path {
+        const FunctionLiteralNode *function;
+        size_t parent;
+        Time own; // Calls, and the time in them outside any statement.
+        std::vector<std::pair<const FunctionLiteralNode *, size_t>> children;
+        std::unordered_map<const StatementNode *, Time> statements;
+    };
+
+    // Charges the time since the last event to `current_`.
+    void charge() {
+        Clock::time_point now = Clock::now();
+        current_->nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_).count();
+        last_ = now;
+    }
+
+    // Indexed by path; a deque so that `current_` and `saved_` stay valid.
+    std::deque<Path> paths_;
+    std::vector<size_t> calls_; // Paths of the calls in progress, innermost last.
+    Time *current_;             // Where the time goes now.
+    std::vector<Time *> saved_; // Where it went before each call and statement in progress.
+    Clock::time_point last_;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_INTERPRETER_PROFILER_H_
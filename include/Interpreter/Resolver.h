@@ -0,0 +1,76 @@
+#ifndef SUPLANG_INTERPRETER_RESOLVER_H_
+#define SUPLANG_INTERPRETER_RESOLVER_H_
+
+#include "AST/ASTNode.h"
+
+#include <map>
+#include <vector>
+
+namespace suplang {
+
+// The Resolver annotates a program with the static addresses used by the
+// Interpreter, so that no variable access needs a name lookup at runtime.
+//
+// Only function calls create environments, so every function literal (and
+// the program itself) is one scope. Its slots are the parameters followed by
+// every name the body declares or assigns. Each VarDeclNode is given its slot
+// in the current scope, and each IdentifierNode the way to reach its binding
+// (see VariableKind).
+//
+// Closures are flat, as with Lua's upvalues: a function literal records the
+// variables of enclosing functions it uses, directly or through functions
+// nested in it, and a function value holds just the Cells of those
+// variables. A variable captured this way lives in a Cell that its own call
+// creates on entry. Top-level variables are never captured; functions read
+// them straight from the globals.
+//
+// The program must be resolved once, after any pass that rewrites the tree
+// and before the passes and backends that read the annotations.
+class Resolver {
+  public:
+    // The upvalue and captured slot lists are allocated in `arena`, the one
+    // holding the tree.
+    explicit Resolver(Arena &arena) : arena_(arena) {}
+
+    // Annotates `program` and returns the names of its top-level slots,
+    // indexed by slot.
+    std::vector<Symbol> resolve(ProgramNode *program);
+    // Annotates a function defined at the top level of a program whose
+    // top-level slots are `globals`, as returned by `resolve`. `resolve`
+    // skips functions whose body is deferred; they are resolved this way once
+    // parsed. Top-level variables are never captured, so resolving them later
+    // changes nothing else in the tree.
+    void resolveFunction(FunctionLiteralNode *function, const std::vector<Symbol> &globals);
+
+  private:
+    struct Scope {
+        std::map<Symbol, size_t> slots;
+        FunctionLiteralNode *function = nullptr; // Null for the program.
+        std::vector<UpvalueRef> upvalues;
+        std::vector<bool> captured; // By slot.
+        // Uses of the scope's own slots, which become cells if captured.
+        std::vector<IdentifierNode *> local_uses;
+        std::vector<VarDeclNode *> declarations;
+    };
+
+    void resolveNode(ASTNode *node);
+    void resolveFunctionLiteral(FunctionLiteralNode *node);
+    void resolveIdentifier(IdentifierNode *node);
+    // Returns the index among the upvalues of `scopes_[level]` of the slot
+    // `slot` of the enclosing `scopes_[owner]`, adding it (and the upvalues
+    // of the functions in between) if needed.
+    size_t upvalue(size_t level, size_t owner, size_t slot);
+
+    // Pushes a scope holding `names` in slot order.
+    void beginScope(const std::vector<Symbol> &names, FunctionLiteralNode *function);
+    // Pops the innermost scope and records its captures.
+    void endScope();
+
+    Arena &arena_;
+    // Every enclosing scope, innermost last.
+    std::vector<Scope> scopes_;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_INTERPRETER_RESOLVER_H_
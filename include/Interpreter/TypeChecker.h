@@ -0,0 +1,75 @@
+#ifndef SUPLANG_INTERPRETER_TYPECHECKER_H_
+#define SUPLANG_INTERPRETER_TYPECHECKER_H_
+
+#include "AST/ASTNode.h"
+
+#include <ostream>
+#include <vector>
+
+namespace suplang {
+
+// The TypeChecker verifies the int32 and bool declarations of a program and
+// annotates every expression with the StaticType it is certain to have, so
+// that the Interpreter can evaluate int32 operators without checking their
+// operands.
+//
+// It reports, before anything runs, the errors that would otherwise produce
+// null in the middle of a run: a declared variable initialized or assigned a
+// value of another type, an arithmetic or comparison operand that is not an
+// int32, a call of something that is not a function, and a variable declared
+// with two different types.
+//
+// A read of a variable has the variable's declared type only when that is
+// certain: the variable is in the current scope, every value written to it
+// has the declared type, and it is assigned on every path to the read. Any
+// other value, such as a call result or a variable of an enclosing scope, is
+// DYNAMIC. Parameters are assumed to have their declared types; the
+// Interpreter checks that assumption once per call.
+class TypeChecker {
+  public:
+    // Checks `program`, which the Resolver has annotated. Returns false after
+    // reporting every type error to std::cerr.
+    bool check(ProgramNode *program);
+    // Checks a function defined at the top level once its deferred body has
+    // been parsed and resolved; `check` skips deferred bodies.
+    bool checkFunction(FunctionLiteralNode *function);
+
+  private:
+    struct Slot {
+        StaticType declared = StaticType::DYNAMIC;
+        // Every value written to the slot has the declared type.
+        bool trusted = true;
+    };
+
+    // Checks one scope: the program or a function body. Passes over the
+    // scope repeat until no more slots lose their trust, then a final pass
+    // annotates the nodes, reports errors and checks nested functions.
+    void checkScope(const ArenaArray<StatementNode *> &statements, size_t num_slots,
+                    const ArenaArray<Parameter> *parameters);
+    void checkFunctionLiteral(FunctionLiteralNode *node);
+
+    // Records the declared type of every variable declared in the scope.
+    void declare(StatementNode *node);
+
+    // Returns the static type of `node`, and records it in the final pass.
+    StaticType expression(ExpressionNode *node);
+    // The type of operator `op` at `node` applied to `left` and `right`.
+    StaticType operatorType(const ExpressionNode *node, Operator op, StaticType left, StaticType right);
+    // Returns whether control can reach the end of `node`.
+    bool statement(StatementNode *node);
+    // Records that a value of `type` is written to `slot`.
+    void store(size_t slot, StaticType type);
+
+    // Starts reporting an error in `node`.
+    std::ostream &error(const ASTNode *node);
+
+    std::vector<Slot> slots_;
+    std::vector<bool> defined_; // Slots certainly assigned at the current point.
+    bool final_pass_ = false;
+    bool changed_ = false;
+    bool ok_ = true;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_INTERPRETER_TYPECHECKER_H_
@@ -0,0 +1,63 @@
+#ifndef SUPLANG_INTERPRETER_VALUESTACK_H_
+#define SUPLANG_INTERPRETER_VALUESTACK_H_
+
+#include "Object/Value.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace suplang {
+
+// The local slots of the calls in progress, as one stack of Values owned by
+// an interpreter. Pushing a call's frame is a bump of the top, so calls
+// allocate nothing on the heap.
+//
+// Call environments can live here because none of them outlives its call:
+// closures capture the Cells of the variables they use, never the frame
+// itself (see Resolver.h). The stack grows in chunks, and a frame never
+// spans two of them, so a frame's slots keep their address until it is
+// popped.
+class ValueStack {
+  public:
+    // Pushes a frame of `size` null slots and returns its first slot.
+    Value *push(size_t size) {
+        Chunk &chunk = chunks_[current_];
+        if (size > chunk.size - chunk.used)
+            return pushChunk(size);
+        Value *frame = chunk.values.get() + chunk.used;
+        chunk.used += size;
+        std::fill(frame, frame + size, Value());
+        return frame;
+    }
+
+    // Pops the most recently pushed frame, whose first slot is `frame`.
+    void pop(Value *frame) {
+        Chunk &chunk = chunks_[current_];
+        chunk.used = frame - chunk.values.get();
+        // Chunks above the first are only current while they hold a frame.
+        if (chunk.used == 0 && current_ > 0)
+            --current_;
+    }
+
+  private:
+    // Values per chunk; a larger frame gets a chunk of its own size.
+    static constexpr size_t kChunkSize = 16 * 1024;
+
+    struct Chunk {
+        std::unique_ptr<Value[]> values;
+        size_t size = 0;
+        size_t used = 0;
+    };
+
+    // Moves to the next chunk, allocating it on first use, and pushes there.
+    Value *pushChunk(size_t size);
+
+    std::vector<Chunk> chunks_ = std::vector<Chunk>(1);
+    size_t current_ = 0;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_INTERPRETER_VALUESTACK_H_
@@ -0,0 +1,62 @@
+#ifndef SUPLANG_JIT_JIT_H_
+#define SUPLANG_JIT_JIT_H_
+
+#include "AST/ASTNode.h"
+#include "Object/Value.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace suplang {
+
+// The static type of a value in JIT-compiled code. Both kinds are held as a
+// 32-bit integer; booleans are 0 or 1.
+enum class JitType : uint8_t { UNKNOWN, INTEGER, BOOLEAN };
+
+// Native code for one function, in its own executable mapping.
+class JitFunction {
+  public:
+    ~JitFunction();
+    JitFunction(const JitFunction &) = delete;
+    JitFunction &operator=(const JitFunction &) = delete;
+
+    // Runs the code on the `argc` values at `args` and stores its result.
+    // Returns false, running nothing, if the arguments are not of the types
+    // the code was compiled for; the caller then interprets the call.
+    bool call(const Value *args, size_t argc, Value *result) const;
+
+  private:
+    friend class JitCompiler;
+    JitFunction() = default;
+
+    using Entry = int32_t (*)(const int32_t *args);
+    void *memory_ = nullptr;
+    size_t size_ = 0;
+    Entry entry_ = nullptr;
+    std::vector<JitType> parameters_;
+    JitType result_ = JitType::UNKNOWN;
+};
+
+// A baseline compiler from functions to x86-64 machine code. It accepts a
+// function whose parameters are declared int32 or bool and whose body only
+// uses its own variables, literals, arithmetic, comparisons, if, while and
+// return, with every variable holding values of a single type and assigned
+// before it is read, and every path producing a value of one type. Those
+// functions can never see null or call anything, so the code needs no type
+// checks beyond the arguments'. Variables live in the native stack frame.
+class JitCompiler {
+  public:
+    // The most parameters a compiled function may have.
+    static constexpr size_t kMaxParameters = 16;
+
+    // Returns null if the function uses anything the JIT does not support,
+    // or if the host is not x86-64 Linux.
+    static std::unique_ptr<JitFunction> compile(const ArenaArray<Parameter> &parameters,
+                                                const BlockStatementNode *body, size_t num_locals);
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_JIT_JIT_H_
@@ -0,0 +1,86 @@
+#ifndef SUPLANG_JIT_X64ASSEMBLER_H_
+#define SUPLANG_JIT_X64ASSEMBLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace suplang {
+
+// A jump target in the code being assembled. Jumps to a label that is not
+// bound yet are patched when it is.
+struct X64Label {
+    int64_t position = -1;
+    std::vector<size_t> fixups; // Offsets of rel32 fields that target the label.
+};
+
+// Condition codes, numbered as in the Jcc and SETcc encodings.
+enum class X64Condition : uint8_t {
+    EQUAL = 0x4,
+    NOT_EQUAL = 0x5,
+    LESS = 0xC,
+    GREATER_EQUAL = 0xD,
+    LESS_EQUAL = 0xE,
+    GREATER = 0xF,
+};
+
+// Returns the condition that holds exactly when `condition` does not.
+X64Condition Negate(X64Condition condition);
+
+// Emits the handful of x86-64 instructions the baseline JIT needs. Values are
+// 32-bit and live in eax (the accumulator) and ecx (the second operand);
+// variables live in the stack frame at fixed offsets from rbp.
+class X64Assembler {
+  public:
+    const std::vector<uint8_t> &code() const { return code_; }
+
+    // push rbp; mov rbp, rsp; sub rsp, frame_size
+    void prologue(int32_t frame_size);
+    // leave; ret
+    void epilogue();
+
+    void loadImmediate(int32_t value);       // mov eax, imm32
+    void loadLocal(int32_t offset);          // mov eax, [rbp + offset]
+    void storeLocal(int32_t offset);         // mov [rbp + offset], eax
+    void loadArgument(int32_t index);        // mov eax, [rdi + 4 * index]
+    void pushAccumulator();                  // push rax
+    void popOperand();                       // mov ecx, eax; pop rax
+    void loadOperandImmediate(int32_t value); // mov ecx, imm32
+    void loadOperandLocal(int32_t offset);    // mov ecx, [rbp + offset]
+
+    void add();                       // add eax, ecx
+    void addImmediate(int32_t value); // add eax, imm32
+    void addLocal(int32_t offset);    // add eax, [rbp + offset]
+    void subtract();
+    void subtractImmediate(int32_t value);
+    void subtractLocal(int32_t offset);
+    void multiply();
+    void multiplyImmediate(int32_t value);
+    void multiplyLocal(int32_t offset);
+    void divide(); // cdq; idiv ecx
+    void negate(); // neg eax
+
+    void compare();                       // cmp eax, ecx
+    void compareImmediate(int32_t value); // cmp eax, imm32
+    void compareLocal(int32_t offset);    // cmp eax, [rbp + offset]
+    void compareOperandImmediate(int32_t value); // cmp ecx, imm32
+    void setCondition(X64Condition condition); // setcc al; movzx eax, al
+    void testAccumulator();                    // test eax, eax
+
+    void jump(X64Label *label);
+    void jumpIf(X64Condition condition, X64Label *label);
+    void bind(X64Label *label);
+
+  private:
+    void emit(uint8_t byte) { code_.push_back(byte); }
+    void emit32(int32_t value);
+    // Emits a ModRM byte addressing [rbp + disp32] followed by the displacement.
+    void emitFrameOperand(uint8_t reg, int32_t offset);
+    void emitTarget(X64Label *label);
+
+    std::vector<uint8_t> code_;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_JIT_X64ASSEMBLER_H_
@@ -0,0 +1,62 @@
+#ifndef SUPLANG_LEXER_CHARCLASS_H_
+#define SUPLANG_LEXER_CHARCLASS_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace suplang {
+
+// Character classes used by the Lexer. Only ASCII bytes are ever classified;
+// everything else (including NUL, which ends the input) has no class.
+enum CharClass : uint8_t {
+    kSpace = 1 << 0,      // ' ', \t, \n, \v, \f, \r
+    kDigit = 1 << 1,      // 0-9
+    kIdentStart = 1 << 2, // A-Z, a-z, _
+    kIdent = 1 << 3,      // A-Z, a-z, 0-9, _
+};
+
+namespace detail {
+constexpr std::array<uint8_t, 256> MakeCharClassTable() {
+    std::array<uint8_t, 256> table{};
+    for (int c = 0; c < 256; ++c) {
+        uint8_t bits = 0;
+        if (c == ' ' || (c >= '\t' && c <= '\r'))
+            bits |= kSpace;
+        if (c >= '0' && c <= '9')
+            bits |= kDigit | kIdent;
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_')
+            bits |= kIdentStart | kIdent;
+        table[c] = bits;
+    }
+    return table;
+}
+} // namespace detail
+
+inline constexpr std::array<uint8_t, 256> kCharClassTable = detail::MakeCharClassTable();
+
+inline bool HasCharClass(char c, CharClass cls) { return kCharClassTable[static_cast<uint8_t>(c)] & cls; }
+
+// Span scanners. Each returns the first position in [begin, end) whose byte
+// is not in the scanned class, or `end`.
+struct ScanKernels {
+    const char *name;
+    const char *(*skip_space)(const char *begin, const char *end);
+    const char *(*skip_ident)(const char *begin, const char *end);
+    const char *(*skip_digits)(const char *begin, const char *end);
+};
+
+// The table-driven, one-byte-at-a-time scanners. Always available.
+const ScanKernels &ScalarScanKernels();
+
+// Scanners that test 16 (SSE2) or 32 (AVX2) bytes per step, or null when the
+// build target or the running CPU lacks the instruction set.
+const ScanKernels *Sse2ScanKernels();
+const ScanKernels *Avx2ScanKernels();
+
+// The fastest scanners supported by the running CPU.
+const ScanKernels &DefaultScanKernels();
+
+} // namespace suplang
+
+#endif // SUPLANG_LEXER_CHARCLASS_H_
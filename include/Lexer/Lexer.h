@@ -1,22 +1,33 @@
 #ifndef SUPLANG_LEXER_LEXER_H_
 #define SUPLANG_LEXER_LEXER_H_
 
+#include "Lexer/CharClass.h"
 #include "Lexer/Token.h"
 
-#include <string>
+#include <string_view>
 
 namespace suplang {
 
 // The Lexer class is responsible for taking a source code string and turning
-// it into a sequence of tokens.
+// it into a sequence of tokens. It never copies the source: tokens are spans
+// of it, so the text (e.g. a SourceBuffer) must outlive the lexer and every
+// token it produces.
 class Lexer {
   public:
-    // Constructor takes the source code string to be tokenized.
-    explicit Lexer(const std::string &source);
+    // Constructor takes the source code to be tokenized. Runs of whitespace,
+    // identifier characters and digits are scanned with `kernels`.
+    explicit Lexer(std::string_view source, const ScanKernels &kernels = DefaultScanKernels());
 
     // Returns the next token from the source code.
     Token nextToken();
 
+    // Returns the source text a token was produced from.
+    std::string_view text(const Token &token) const { return source_.substr(token.offset, token.length); }
+
+    // Continues from `offset`, whose position is `location`, as when parsing
+    // a part of a source that was lexed before.
+    void resumeAt(size_t offset, SourceLocation location);
+
   private:
     // Moves the lexer's position to the next character.
     void advance();
@@ -24,6 +35,9 @@ class Lexer {
     // Returns the character immediately after the current one without advancing.
     char peekChar();
 
+    // Moves the lexer's position to `p`, a pointer into source_.
+    void seek(const char *p);
+
     // Skips over any whitespace characters (spaces, tabs, newlines).
     void skipWhitespace();
 
@@ -33,11 +47,17 @@ class Lexer {
     // Consumes a sequence of digits as a number.
     Token makeNumber();
 
-    const std::string source_;
+    // Builds a token of `type` spanning from `start` to the current position.
+    Token makeToken(TokenType type, size_t start) const;
+
+    const std::string_view source_;
+    const ScanKernels &kernels_;
     size_t position_ = 0;   // Current position in the source_ string.
     char current_char_ = 0; // The character at the current position.
+    uint32_t line_ = 1;     // Line of the current position.
+    size_t line_start_ = 0; // Offset of the first character of that line.
 };
 
 } // namespace suplang
 
-#endif // SUPLANG_LEXER_LEXER_H_
\ No newline at end of file
+#endif // SUPLANG_LEXER_LEXER_H_
@@ -0,0 +1,38 @@
+#ifndef SUPLANG_LEXER_SOURCEBUFFER_H_
+#define SUPLANG_LEXER_SOURCEBUFFER_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace suplang {
+
+// An immutable block of source text. The Lexer and its tokens refer into the
+// buffer instead of copying it, so it must outlive both.
+class SourceBuffer {
+  public:
+    // Takes ownership of an in-memory string.
+    static std::unique_ptr<SourceBuffer> FromString(std::string text);
+
+    // Maps the file at `path` into memory read-only, falling back to reading
+    // it where mmap is unavailable. Returns null if the file cannot be read.
+    static std::unique_ptr<SourceBuffer> FromFile(const std::string &path);
+
+    ~SourceBuffer();
+    SourceBuffer(const SourceBuffer &) = delete;
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+    std::string_view text() const { return text_; }
+
+  private:
+    SourceBuffer() = default;
+
+    std::string owned_;          // Backing store when the text is not mapped.
+    void *mapping_ = nullptr;    // Start of the mapped region, if any.
+    size_t mapping_size_ = 0;
+    std::string_view text_;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_LEXER_SOURCEBUFFER_H_
@@ -0,0 +1,56 @@
+#ifndef SUPLANG_LEXER_SYMBOL_H_
+#define SUPLANG_LEXER_SYMBOL_H_
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace suplang {
+
+// A small integer standing for an interned identifier name. Two names are
+// equal exactly when their symbols are, so the parser, the compilers and the
+// runtime never compare or hash name strings.
+using Symbol = uint32_t;
+
+// Marks the absence of a symbol.
+constexpr Symbol kNoSymbol = UINT32_MAX;
+
+// Assigns every distinct name a dense Symbol, starting at 0. Lookups go
+// through an open-addressing hash table with linear probing. All methods are
+// thread-safe, and a name returned by `name` stays valid for the lifetime of
+// the table.
+class SymbolTable {
+  public:
+    // The process-wide table shared by the Lexer, Parser and runtime.
+    static SymbolTable &Global();
+
+    // Returns the symbol for `name`, adding it if it is new.
+    Symbol intern(std::string_view name);
+
+    // Returns the symbol for `name`, or kNoSymbol if it was never interned.
+    Symbol find(std::string_view name) const;
+
+    // Returns the name `symbol` was interned from.
+    const std::string &name(Symbol symbol) const;
+
+  private:
+    // Returns the bucket holding `name`, or the empty bucket where it belongs.
+    size_t probe(std::string_view name, uint32_t hash) const;
+    void grow();
+
+    std::deque<std::string> names_; // Indexed by symbol; a deque never moves its elements.
+    std::vector<uint32_t> hashes_;  // Indexed by symbol.
+    std::vector<Symbol> buckets_;   // kNoSymbol marks an empty bucket.
+    mutable std::mutex mutex_;
+};
+
+// Shorthands for the global table.
+inline Symbol Intern(std::string_view name) { return SymbolTable::Global().intern(name); }
+inline const std::string &SymbolName(Symbol symbol) { return SymbolTable::Global().name(symbol); }
+
+} // namespace suplang
+
+#endif // SUPLANG_LEXER_SYMBOL_H_
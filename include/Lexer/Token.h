@@ -1,7 +1,9 @@
 #ifndef SUPLANG_LEXER_TOKEN_H_
 #define SUPLANG_LEXER_TOKEN_H_
 
-#include <string>
+#include "Lexer/Symbol.h"
+
+#include <cstdint>
 
 namespace suplang {
 
@@ -52,10 +54,21 @@ enum class TokenType {
     END_OF_FILE,
 };
 
-// Represents a single token.
+// A position in the source, both 1-based. Columns count bytes. A line of 0
+// means the position is unknown.
+struct SourceLocation {
+    uint32_t line = 0;
+    uint32_t column = 0;
+};
+
+// Represents a single token. The token's text is not copied; it is the
+// `length` bytes at `offset` in the lexer's source (see Lexer::text).
 struct Token {
-    TokenType type;
-    std::string value;
+    TokenType type = TokenType::END_OF_FILE;
+    uint32_t offset = 0;
+    uint32_t length = 0;
+    Symbol symbol = kNoSymbol; // The interned name of an IDENTIFIER.
+    SourceLocation location;   // Where the token starts.
 };
 
 } // namespace suplang
@@ -0,0 +1,111 @@
+#ifndef SUPLANG_OBJECT_HEAP_H_
+#define SUPLANG_OBJECT_HEAP_H_
+
+#include "Object/Object.h"
+#include "Object/SlabPool.h"
+#include "Object/Value.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace suplang {
+
+// Tuning knobs of the garbage collector.
+struct GcOptions {
+    // Bytes the heap may hold before the first collection, and the lowest
+    // threshold it ever goes back to.
+    size_t initial_threshold = 1 << 20;
+    // After a collection, the next one runs once the heap has grown to this
+    // multiple of the bytes that survived.
+    double growth_factor = 2.0;
+    // Collects before every allocation. Slow, but exposes missing roots.
+    bool stress = false;
+};
+
+// Counters accumulated over the lifetime of a Heap.
+struct GcStats {
+    size_t collections = 0;
+    size_t objects_allocated = 0;
+    size_t objects_freed = 0;
+    size_t bytes_freed = 0;
+    std::chrono::nanoseconds total_pause{0};
+    std::chrono::nanoseconds max_pause{0};
+};
+
+// A mark-and-sweep heap that owns every object allocated through it and
+// frees the ones that are no longer reachable, cycles included. Objects are
+// carved from the slab pool of the calling thread, so a heap must stay on
+// the thread that created it.
+//
+// Collections only happen inside `allocate`. Before allocating, callers must
+// make sure every object they still need is reachable from the roots that
+// the root marker reports.
+class Heap {
+  public:
+    // Marks the roots of the heap's owner through `markValue`/`markObject`.
+    using RootMarker = std::function<void(Heap &)>;
+
+    explicit Heap(GcOptions options = {}) : options_(options), next_gc_(options.initial_threshold) {}
+    ~Heap();
+
+    Heap(const Heap &) = delete;
+    Heap &operator=(const Heap &) = delete;
+
+    void setRootMarker(RootMarker marker) { root_marker_ = std::move(marker); }
+
+    // Creates an object owned by the heap, collecting first if the heap has
+    // outgrown its threshold.
+    template <typename T, typename... Args> T *allocate(Args &&...args) {
+        if (options_.stress || bytes_allocated_ >= next_gc_) {
+            collect();
+        }
+        T *object = new (SlabPool::Local().allocate(sizeof(T))) T(std::forward<Args>(args)...);
+        object->next = objects_;
+        objects_ = object;
+        bytes_allocated_ += SizeOf(object);
+        ++stats_.objects_allocated;
+        return object;
+    }
+
+    void markValue(const Value &value) {
+        if (value.isObject())
+            markObject(value.asObject());
+    }
+    void markObject(Object *object);
+
+    // Frees every object that is not reachable from the roots.
+    void collect();
+
+    size_t bytesAllocated() const { return bytes_allocated_; }
+    const GcStats &stats() const { return stats_; }
+
+  private:
+    // Approximate number of bytes `object` keeps allocated.
+    static size_t SizeOf(const Object *object);
+    // Size of the pool block holding `object`.
+    static size_t BlockSize(const Object *object);
+    // Destroys `object` and returns its block to the pool.
+    static void Free(Object *object);
+
+    void blacken(Object *object);
+    void sweep();
+
+    GcOptions options_;
+    RootMarker root_marker_;
+    Object *objects_ = nullptr; // Every owned object, newest first.
+    std::vector<Object *> gray_; // Marked objects whose references are not yet marked.
+    size_t bytes_allocated_ = 0;
+    size_t next_gc_;
+    GcStats stats_;
+};
+
+// Writes a human-readable summary of `stats`.
+void PrintGcStats(const GcStats &stats, size_t bytes_live, std::ostream &out);
+
+} // namespace suplang
+
+#endif // SUPLANG_OBJECT_HEAP_H_
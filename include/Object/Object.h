@@ -2,23 +2,25 @@
 #define SUPLANG_OBJECT_OBJECT_H_
 
 #include "AST/ASTNode.h" // Required for function body and parameters.
+#include "Object/SlabPool.h"
+#include "Object/Value.h"
 
 #include <cstdint>
-#include <memory>
-#include <string>
 #include <vector>
 
 namespace suplang {
 
-// Forward declaration to break the circular dependency with Environment.h.
-class Environment;
+class JitFunction;
 
-// Enum for all possible object types in the language's runtime.
+// Enum for all possible heap object types in the language's runtime.
+// Integers and booleans are not objects; they live inline in a Value.
 enum class ObjectType {
-    INTEGER,
-    BOOLEAN,
     FUNCTION,
-    RETURN_VALUE,
+    COMPILED_FUNCTION,
+    REGISTER_FUNCTION,
+    CLOSURE_FUNCTION,
+    ENVIRONMENT,
+    CELL,
 };
 
 // Base class for all runtime objects.
@@ -26,40 +28,37 @@ class Object {
   public:
     ObjectType type;
     virtual ~Object() = default;
-};
 
-// Represents an integer object at runtime.
-class IntegerObject : public Object {
-  public:
-    explicit IntegerObject(int32_t val) : value(val) { type = ObjectType::INTEGER; }
-    int32_t value;
+    // Bookkeeping of the Heap that owns the object, if any.
+    bool marked = false;
+    Object *next = nullptr;
 };
 
-// Represents a boolean object at runtime.
-class BooleanObject : public Object {
+// A boxed variable, shared between the call that declares it and the
+// closures that capture it.
+class Cell : public Object {
   public:
-    explicit BooleanObject(bool val) : value(val) { type = ObjectType::BOOLEAN; }
-    bool value;
+    explicit Cell(Value value) : value(value) { type = ObjectType::CELL; }
+    Value value;
 };
 
+// The Cell a slot of a captured variable holds.
+inline Cell *AsCell(Value value) { return static_cast<Cell *>(value.asObject()); }
+
+// The Cells a closure captured, by upvalue index.
+using Upvalues = std::vector<Cell *, SlabAllocator<Cell *>>;
+
 // Represents a function object at runtime.
 class FunctionObject : public Object {
   public:
-    // The constructor is only declared here; its definition is in Object.cpp
-    // to avoid needing the full definition of Environment in this header.
-    FunctionObject(std::vector<Parameter> params, std::unique_ptr<BlockStatementNode> body,
-                   std::shared_ptr<Environment> env);
+    explicit FunctionObject(const FunctionLiteralNode *literal) : literal(literal) { type = ObjectType::FUNCTION; }
 
-    std::vector<Parameter> parameters;
-    std::unique_ptr<BlockStatementNode> body;
-    std::shared_ptr<Environment> env;
-};
-
-// A wrapper object used to signal a return from a function call.
-class ReturnValueObject : public Object {
-  public:
-    explicit ReturnValueObject(std::shared_ptr<Object> val) : value(val) { type = ObjectType::RETURN_VALUE; }
-    std::shared_ptr<Object> value;
+    // The definition, in the SyntaxTree the function was defined in. Its
+    // body may still be deferred (see LazyFunctions).
+    const FunctionLiteralNode *literal;
+    Upvalues upvalues;                // The captured variables, kept alive by the collector.
+    const JitFunction *jit = nullptr; // Native code for the body, if it was compiled.
+    bool jit_pending = false;         // The body is to be compiled once parsed.
 };
 
 } // namespace suplang
@@ -0,0 +1,113 @@
+#ifndef SUPLANG_OBJECT_SLABPOOL_H_
+#define SUPLANG_OBJECT_SLABPOOL_H_
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <vector>
+
+namespace suplang {
+
+// Counters of one thread's slab pool.
+struct SlabStats {
+    size_t allocated = 0;      // Blocks handed out, recycled or fresh.
+    size_t recycled = 0;       // Blocks handed out again after being freed.
+    size_t live = 0;           // Blocks currently in use.
+    size_t reserved_bytes = 0; // Bytes held in slabs.
+};
+
+// Size-class pools of fixed-size blocks carved out of 64 KiB slabs. A freed
+// block goes onto the free list of its class and is handed out again by the
+// next allocation of that size, so short-lived runtime objects never reach
+// the general-purpose allocator. Requests above kMaxBlockSize fall through
+// to operator new.
+//
+// Every thread has its own pool and its free lists are not synchronized: a
+// block must be freed on the thread that allocated it.
+class SlabPool {
+  public:
+    static constexpr size_t kGranularity = 16;
+    static constexpr size_t kMaxBlockSize = 256;
+
+    // The calling thread's pool.
+    static SlabPool &Local();
+
+    void *allocate(size_t size) {
+        if (size > kMaxBlockSize)
+            return ::operator new(size);
+        ++stats_.allocated;
+        ++stats_.live;
+        size_t size_class = ClassOf(size);
+        if (FreeBlock *block = free_lists_[size_class]) {
+            free_lists_[size_class] = block->next;
+            ++stats_.recycled;
+            return block;
+        }
+        return carve(size_class);
+    }
+
+    void deallocate(void *memory, size_t size) {
+        if (size > kMaxBlockSize) {
+            ::operator delete(memory);
+            return;
+        }
+        FreeBlock *&head = free_lists_[ClassOf(size)];
+        auto block = static_cast<FreeBlock *>(memory);
+        block->next = head;
+        head = block;
+        --stats_.live;
+    }
+
+    const SlabStats &stats() const { return stats_; }
+
+  private:
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    static constexpr size_t kSlabSize = 64 * 1024;
+    static constexpr size_t kNumClasses = kMaxBlockSize / kGranularity;
+
+    // Class 0 holds blocks of up to 16 bytes, class 1 up to 32, and so on.
+    static size_t ClassOf(size_t size) { return size == 0 ? 0 : (size - 1) / kGranularity; }
+
+    // The unused tail of the slab a size class is currently carving from.
+    struct Region {
+        char *next = nullptr;
+        char *end = nullptr;
+    };
+
+    // Hands out a never-used block of `size_class`, starting a new slab when
+    // the current one is exhausted.
+    void *carve(size_t size_class);
+
+    std::array<FreeBlock *, kNumClasses> free_lists_{};
+    std::array<Region, kNumClasses> regions_{};
+    std::vector<std::unique_ptr<char[]>> slabs_;
+    SlabStats stats_;
+};
+
+// A standard allocator over the calling thread's SlabPool, for containers
+// owned by pooled objects.
+template <typename T> class SlabAllocator {
+  public:
+    using value_type = T;
+
+    SlabAllocator() = default;
+    template <typename U> SlabAllocator(const SlabAllocator<U> &) {}
+
+    T *allocate(size_t n) { return static_cast<T *>(SlabPool::Local().allocate(n * sizeof(T))); }
+    void deallocate(T *p, size_t n) { SlabPool::Local().deallocate(p, n * sizeof(T)); }
+
+    template <typename U> bool operator==(const SlabAllocator<U> &) const { return true; }
+    template <typename U> bool operator!=(const SlabAllocator<U> &) const { return false; }
+};
+
+// Writes a human-readable summary of `stats`.
+void PrintSlabStats(const SlabStats &stats, std::ostream &out);
+
+} // namespace suplang
+
+#endif // SUPLANG_OBJECT_SLABPOOL_H_
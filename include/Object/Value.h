@@ -0,0 +1,71 @@
+#ifndef SUPLANG_OBJECT_VALUE_H_
+#define SUPLANG_OBJECT_VALUE_H_
+
+#include <cstdint>
+
+namespace suplang {
+
+// Forward declaration to break the circular dependency with Object.h.
+class Object;
+
+// Integers are 32 bits and wrap around on overflow. Arithmetic is done on
+// uint32_t, where wrapping is defined, and converted back with Wrap.
+inline int32_t Wrap(uint32_t value) { return static_cast<int32_t>(value); }
+// Division truncates. Its one overflow, INT32_MIN / -1, wraps as the negation
+// it is; dividing by zero is not defined.
+inline int32_t Divide(int32_t a, int32_t b) { return b == -1 ? Wrap(0u - static_cast<uint32_t>(a)) : a / b; }
+
+// Enum for the kinds of value a Value can hold.
+enum class ValueType : uint8_t {
+    NIL,
+    INTEGER,
+    BOOLEAN,
+    OBJECT,
+};
+
+// A runtime value. Integers and booleans are stored inline, so producing one
+// never allocates; only reference types such as functions are boxed in a
+// heap Object. Values do not own their object: a Heap (or, for compiled
+// functions, the program) does, so copying a Value is a plain copy.
+class Value {
+  public:
+    // Constructs the null value.
+    Value() = default;
+
+    static Value Integer(int32_t value) { return Value(ValueType::INTEGER, value); }
+    static Value Boolean(bool value) { return Value(ValueType::BOOLEAN, value ? 1 : 0); }
+    // Wraps a heap object; a null pointer yields the null value.
+    static Value FromObject(Object *object) {
+        Value value;
+        if (object) {
+            value.type_ = ValueType::OBJECT;
+            value.object_ = object;
+        }
+        return value;
+    }
+
+    ValueType type() const { return type_; }
+    bool isNil() const { return type_ == ValueType::NIL; }
+    bool isInteger() const { return type_ == ValueType::INTEGER; }
+    bool isBoolean() const { return type_ == ValueType::BOOLEAN; }
+    bool isObject() const { return type_ == ValueType::OBJECT; }
+
+    int32_t asInteger() const { return payload_; }
+    bool asBoolean() const { return payload_ != 0; }
+    Object *asObject() const { return object_; }
+
+    // In our language, only null and the boolean `false` are falsy.
+    // Everything else (including the number 0) is considered truthy.
+    bool isTruthy() const { return type_ == ValueType::BOOLEAN ? payload_ != 0 : type_ != ValueType::NIL; }
+
+  private:
+    Value(ValueType type, int32_t payload) : type_(type), payload_(payload) {}
+
+    ValueType type_ = ValueType::NIL;
+    int32_t payload_ = 0; // The integer, or 0/1 for a boolean.
+    Object *object_ = nullptr;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_OBJECT_VALUE_H_
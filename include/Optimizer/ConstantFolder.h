@@ -0,0 +1,58 @@
+#ifndef SUPLANG_OPTIMIZER_CONSTANTFOLDER_H_
+#define SUPLANG_OPTIMIZER_CONSTANTFOLDER_H_
+
+#include "AST/ASTNode.h"
+
+#include <utility>
+
+namespace suplang {
+
+// The ConstantFolder rewrites a freshly parsed program in place, before it is
+// resolved or compiled, so that no backend re-evaluates what the source
+// already decides:
+//
+//  - Infix and prefix expressions over integer literals become number or
+//    boolean literals. Division by zero is left for the runtime to report.
+//  - `e + 0`, `0 + e`, `e - 0`, `e * 1`, `1 * e` and `e / 1` become `e` when
+//    `e` is itself arithmetic. A name is left alone: it may hold a
+//    non-integer, for which `x + 0` is null rather than `x`.
+//  - An `if` or `while` whose condition is a literal keeps only the code
+//    that runs, unless the dropped code binds a name, which would change how
+//    the Resolver lays out the enclosing scope.
+//
+// New nodes are allocated in the tree's arena.
+class ConstantFolder {
+  public:
+    explicit ConstantFolder(Arena &arena) : arena_(arena) {}
+
+    void fold(ProgramNode *program);
+    // Folds the body of one function, such as a lazily parsed one.
+    void foldFunction(FunctionLiteralNode *function);
+
+  private:
+    void foldStatements(const ArenaArray<StatementNode *> &statements);
+    // Returns the statement that replaces `node`, which may be `node` itself.
+    StatementNode *foldStatement(StatementNode *node);
+    StatementNode *foldIfStatement(IfStatementNode *node);
+    StatementNode *foldWhileStatement(WhileStatementNode *node);
+
+    // Returns the expression that replaces `node`, which may be `node` itself.
+    ExpressionNode *foldExpression(ExpressionNode *node);
+    ExpressionNode *foldInfixExpression(InfixExpressionNode *node);
+    ExpressionNode *foldPrefixExpression(PrefixExpressionNode *node);
+
+    // A block with no statements, standing in for removed code.
+    BlockStatementNode *emptyBlock(const ASTNode *replaced);
+    // Makes a node that stands in for `replaced`, at its location.
+    template <typename T, typename... Args> T *replace(const ASTNode *replaced, Args &&...args) {
+        T *node = arena_.make<T>(std::forward<Args>(args)...);
+        node->location = replaced->location;
+        return node;
+    }
+
+    Arena &arena_;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_OPTIMIZER_CONSTANTFOLDER_H_
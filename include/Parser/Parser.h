@@ -4,7 +4,7 @@
 #include "AST/ASTNode.h"
 #include "Lexer/Lexer.h"
 
-#include <map>
+#include <utility>
 #include <vector>
 
 namespace suplang {
@@ -22,38 +22,61 @@ enum Precedence {
 
 class Parser {
   public:
-    explicit Parser(Lexer &lexer);
-    std::unique_ptr<ProgramNode> parseProgram();
+    // With `defer_function_bodies`, the bodies of functions defined outside
+    // any other function are only brace-matched, and left for LazyFunctions
+    // to parse on first call. Functions nested in them are parsed with them.
+    explicit Parser(Lexer &lexer, bool defer_function_bodies = false);
+    // Parses the whole input into a tree that owns all of its nodes.
+    SyntaxTree parseProgram();
+    // Parses a function body, starting at its `{`, into `arena`.
+    BlockStatementNode *parseFunctionBody(Arena &arena);
+    // The number of errors reported so far.
+    size_t errorCount() const { return error_count_; }
 
   private:
     void nextToken();
     bool expectPeek(TokenType type);
+    // Precedence of the next token as an infix operator, LOWEST if it is none.
+    Precedence peekPrecedence() const;
 
     // Statement parsers.
-    std::unique_ptr<StatementNode> parseStatement();
-    std::unique_ptr<StatementNode> parseVarDeclStatement();
-    std::unique_ptr<StatementNode> parseIfStatement();
-    std::unique_ptr<StatementNode> parseWhileStatement(); // New parser method.
-    std::unique_ptr<BlockStatementNode> parseBlockStatement();
-    std::unique_ptr<StatementNode> parseExpressionStatement();
-    std::unique_ptr<StatementNode> parseReturnStatement();
+    StatementNode *parseStatement();
+    StatementNode *parseVarDeclStatement();
+    StatementNode *parseIfStatement();
+    StatementNode *parseWhileStatement(); // New parser method.
+    BlockStatementNode *parseBlockStatement();
+    StatementNode *parseExpressionStatement();
+    StatementNode *parseReturnStatement();
 
     // Expression parsers.
-    std::unique_ptr<ExpressionNode> parseExpression(Precedence precedence);
-    std::unique_ptr<ExpressionNode> parseIdentifier();
-    std::unique_ptr<ExpressionNode> parseIntegerLiteral();
-    std::unique_ptr<ExpressionNode> parseBoolean();
-    std::unique_ptr<ExpressionNode> parsePrefixExpression();
-    std::unique_ptr<ExpressionNode> parseInfixExpression(std::unique_ptr<ExpressionNode> left);
-    std::unique_ptr<ExpressionNode> parseFunctionLiteral();
-    std::vector<Parameter> parseFunctionParameters();
-    std::unique_ptr<ExpressionNode> parseCallExpression(std::unique_ptr<ExpressionNode> function);
-    std::vector<std::unique_ptr<ExpressionNode>> parseCallArguments();
+    ExpressionNode *parseExpression(Precedence precedence);
+    ExpressionNode *parseIdentifier();
+    ExpressionNode *parseIntegerLiteral();
+    ExpressionNode *parseBoolean();
+    ExpressionNode *parsePrefixExpression();
+    ExpressionNode *parseInfixExpression(ExpressionNode *left);
+    ExpressionNode *parseFunctionLiteral();
+    ArenaArray<Parameter> parseFunctionParameters();
+    ExpressionNode *parseCallExpression(ExpressionNode *function);
+    ArenaArray<ExpressionNode *> parseCallArguments();
+
+    // Skips the tokens of a block, from its `{` to the matching `}`.
+    void skipBlock();
+
+    // Makes a node in the tree's arena, starting at `location`.
+    template <typename T, typename... Args> T *make(SourceLocation location, Args &&...args) {
+        T *node = arena_->make<T>(std::forward<Args>(args)...);
+        node->location = location;
+        return node;
+    }
 
     Lexer &lexer_;
+    Arena *arena_ = nullptr; // The arena of the tree being parsed.
+    bool defer_function_bodies_;
+    int function_depth_ = 0; // Function bodies enclosing the current token.
+    size_t error_count_ = 0;
     Token current_token_;
     Token peek_token_;
-    std::map<TokenType, Precedence> precedences_;
 };
 
 } // namespace suplang
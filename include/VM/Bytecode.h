@@ -0,0 +1,82 @@
+#ifndef SUPLANG_VM_BYTECODE_H_
+#define SUPLANG_VM_BYTECODE_H_
+
+#include "Object/Object.h"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace suplang {
+
+// Instruction set of the stack-based virtual machine. Operands follow the
+// opcode byte inline; every operand is a little-endian uint16.
+enum class OpCode : uint8_t {
+    CONSTANT,      // [index] Pushes constants[index].
+    NIL,           // Pushes the null value.
+    TRUE,          // Pushes `true`.
+    FALSE,         // Pushes `false`.
+    POP,           // Discards the top of the stack.
+    GET_LOCAL,     // [slot] Pushes a local of the current frame.
+    SET_LOCAL,     // [slot] Stores the top of the stack into a local, leaving it on the stack.
+    GET_GLOBAL,    // [index] Pushes a global variable.
+    SET_GLOBAL,    // [index] Stores the top of the stack into a global, leaving it on the stack.
+    ADD,           // Pops two operands and pushes the result.
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    LESS,
+    GREATER,
+    EQUAL,
+    NOT_EQUAL,
+    NEGATE,        // Replaces the top of the stack with its negation.
+    JUMP,          // [offset] Jumps forward.
+    JUMP_IF_FALSE, // [offset] Pops the condition and jumps forward if it is falsy.
+    LOOP,          // [offset] Jumps backward.
+    CALL,          // [argc] Calls the function sitting below `argc` arguments.
+    TAIL_CALL,     // [argc] As CALL, but a function callee takes over the current frame.
+    RETURN,        // Pops the result and returns it to the caller.
+};
+
+// A sequence of bytecode together with the constants it references.
+struct Chunk {
+    std::vector<uint8_t> code;
+    std::vector<Value> constants;
+    // Owns the objects among the constants, which outlive any one run.
+    std::vector<std::unique_ptr<Object>> objects;
+};
+
+// The compiled form of a function literal (or of the top-level script).
+// Parameters occupy the first `arity` local slots.
+struct FunctionProto {
+    std::string name;
+    size_t arity = 0;
+    size_t num_locals = 0;
+    Chunk chunk;
+};
+
+// The result of compiling a whole program.
+struct CompiledProgram {
+    std::shared_ptr<FunctionProto> script;
+    // Names of the global variables, indexed by their global slot.
+    std::vector<Symbol> global_names;
+};
+
+// Represents a compiled function at runtime.
+class CompiledFunctionObject : public Object {
+  public:
+    explicit CompiledFunctionObject(std::shared_ptr<FunctionProto> proto) : proto(std::move(proto)) {
+        type = ObjectType::COMPILED_FUNCTION;
+    }
+    std::shared_ptr<FunctionProto> proto;
+};
+
+// Writes a human-readable listing of `proto` and of every function nested in
+// its constant pool.
+void Disassemble(const FunctionProto &proto, std::ostream &out);
+
+} // namespace suplang
+
+#endif // SUPLANG_VM_BYTECODE_H_
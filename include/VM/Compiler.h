@@ -0,0 +1,72 @@
+#ifndef SUPLANG_VM_COMPILER_H_
+#define SUPLANG_VM_COMPILER_H_
+
+#include "AST/ASTNode.h"
+#include "VM/Bytecode.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace suplang {
+
+// The Compiler class translates an AST into bytecode for the stack VM.
+//
+// Names are resolved at compile time. Inside a function, parameters and every
+// name the body declares or assigns become numbered local slots; all other
+// names, and every name at the top level, are global slots. The VM has no
+// closures, so a function using a variable of an enclosing function is an
+// error.
+class Compiler {
+  public:
+    CompiledProgram compile(ProgramNode *program);
+    // The number of errors reported while compiling; the program must not be
+    // run unless it is zero.
+    size_t errorCount() const { return error_count_; }
+
+  private:
+    // Statement compilers. When `want_value` is true the statement leaves
+    // exactly one value (its completion value) on the stack.
+    void compileBlock(const ArenaArray<StatementNode *> &statements, bool want_value);
+    void compileStatement(StatementNode *node, bool want_value);
+    void compileIfStatement(IfStatementNode *node, bool want_value);
+    void compileWhileStatement(WhileStatementNode *node, bool want_value);
+
+    // Expression compilers. Every expression leaves exactly one value.
+    void compileExpression(ExpressionNode *node);
+    void compileInfixExpression(InfixExpressionNode *node);
+    void compileFunctionLiteral(FunctionLiteralNode *node);
+    // Emits the callee, the arguments and `op`, CALL or TAIL_CALL.
+    void compileCall(CallExpressionNode *node, OpCode op);
+
+    // Name resolution helpers.
+    void declareLocal(Symbol name);
+    void emitGet(Symbol name);
+    void emitSet(Symbol name);
+    uint16_t globalSlot(Symbol name);
+
+    // Emission helpers.
+    void emitOp(OpCode op);
+    void emitOperand(size_t operand);
+    void emitOp(OpCode op, size_t operand);
+    uint16_t integerConstant(int32_t value);
+    uint16_t addConstant(Value value);
+    size_t emitJump(OpCode op);
+    void patchJump(size_t operand_offset);
+    void emitLoop(size_t loop_start);
+
+    FunctionProto *current_ = nullptr;
+    // Local slots of the function being compiled; null at the top level.
+    std::map<Symbol, uint16_t> *locals_ = nullptr;
+    // Constant slot of each integer the current function uses, so that
+    // repeated literals share one entry.
+    std::map<int32_t, uint16_t> *integer_constants_ = nullptr;
+    std::map<Symbol, uint16_t> global_slots_;
+    std::vector<Symbol> global_names_;
+    size_t error_count_ = 0;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_VM_COMPILER_H_
@@ -0,0 +1,19 @@
+#ifndef SUPLANG_VM_LOCALS_H_
+#define SUPLANG_VM_LOCALS_H_
+
+#include "AST/ASTNode.h"
+
+#include <vector>
+
+namespace suplang {
+
+// Appends to `names`, in first-occurrence order and without duplicates, every
+// name that a function body binds: variable declarations and assignment
+// targets. This mirrors the interpreter, where both always write to the
+// call's own environment. Nested function literals are skipped since they get
+// their own frame.
+void CollectLocals(const ASTNode *node, std::vector<Symbol> *names);
+
+} // namespace suplang
+
+#endif // SUPLANG_VM_LOCALS_H_
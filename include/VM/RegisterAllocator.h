@@ -0,0 +1,21 @@
+#ifndef SUPLANG_VM_REGISTERALLOCATOR_H_
+#define SUPLANG_VM_REGISTERALLOCATOR_H_
+
+#include "VM/RegisterBytecode.h"
+
+#include <cstddef>
+
+namespace suplang {
+
+// Maps the virtual registers used by `proto->code` onto as few frame registers
+// as possible with linear-scan allocation over live intervals, then rewrites
+// the code in place, drops moves that became no-ops and sets
+// `proto->num_registers`.
+//
+// Virtual registers 0..arity-1 hold the parameters and stay pinned to the
+// frame registers of the same number.
+void AllocateRegisters(RegisterProto *proto, size_t num_virtual_registers);
+
+} // namespace suplang
+
+#endif // SUPLANG_VM_REGISTERALLOCATOR_H_
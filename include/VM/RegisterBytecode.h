@@ -0,0 +1,86 @@
+#ifndef SUPLANG_VM_REGISTERBYTECODE_H_
+#define SUPLANG_VM_REGISTERBYTECODE_H_
+
+#include "Object/Object.h"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace suplang {
+
+// Operands marked RK name either a frame register or, when kConstantBit is
+// set, an entry of the constant pool.
+constexpr uint16_t kConstantBit = 0x8000;
+
+// Instruction set of the register-based virtual machine. Every instruction
+// has three operands; R(x) is a register, RK(x) a register or constant.
+enum class RegOpCode : uint8_t {
+    MOVE,              // R(a) = RK(b)
+    GET_GLOBAL,        // R(a) = globals[b]
+    SET_GLOBAL,        // globals[b] = RK(a)
+    ADD,               // R(a) = RK(b) + RK(c)
+    SUBTRACT,          // R(a) = RK(b) - RK(c)
+    MULTIPLY,          // R(a) = RK(b) * RK(c)
+    DIVIDE,            // R(a) = RK(b) / RK(c)
+    LESS,              // R(a) = RK(b) < RK(c)
+    GREATER,           // R(a) = RK(b) > RK(c)
+    EQUAL,             // R(a) = RK(b) == RK(c)
+    NOT_EQUAL,         // R(a) = RK(b) != RK(c)
+    NEGATE,            // R(a) = -RK(b)
+    JUMP,              // pc = a
+    JUMP_IF_FALSE,     // if not RK(b) then pc = a
+    JUMP_UNLESS_LESS,  // if not (RK(b) < RK(c)) then pc = a
+    JUMP_UNLESS_GREATER,
+    JUMP_UNLESS_EQUAL,
+    JUMP_UNLESS_NOT_EQUAL,
+    CALL,              // R(a) = RK(b)(...); followed by c ARG instructions
+    TAIL_CALL,         // as CALL, but a function RK(b) takes over the current frame
+    ARG,               // RK(a) is the next argument of the preceding CALL
+    RETURN,            // return RK(a)
+};
+
+struct RegInstruction {
+    RegOpCode op;
+    uint16_t a = 0;
+    uint16_t b = 0;
+    uint16_t c = 0;
+};
+
+// The compiled form of a function literal (or of the top-level script).
+// Parameters arrive in registers 0..arity-1.
+struct RegisterProto {
+    std::string name;
+    size_t arity = 0;
+    size_t num_registers = 0;
+    std::vector<RegInstruction> code;
+    std::vector<Value> constants;
+    // Owns the objects among the constants, which outlive any one run.
+    std::vector<std::unique_ptr<Object>> objects;
+};
+
+// The result of compiling a whole program for the register VM.
+struct RegisterProgram {
+    std::shared_ptr<RegisterProto> script;
+    // Names of the global variables, indexed by their global slot.
+    std::vector<Symbol> global_names;
+};
+
+// Represents a function compiled for the register VM at runtime.
+class RegisterFunctionObject : public Object {
+  public:
+    explicit RegisterFunctionObject(std::shared_ptr<RegisterProto> proto) : proto(std::move(proto)) {
+        type = ObjectType::REGISTER_FUNCTION;
+    }
+    std::shared_ptr<RegisterProto> proto;
+};
+
+// Writes a human-readable listing of `proto` and of every function nested in
+// its constant pool.
+void Disassemble(const RegisterProto &proto, std::ostream &out);
+
+} // namespace suplang
+
+#endif // SUPLANG_VM_REGISTERBYTECODE_H_
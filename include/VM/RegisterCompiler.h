@@ -0,0 +1,87 @@
+#ifndef SUPLANG_VM_REGISTERCOMPILER_H_
+#define SUPLANG_VM_REGISTERCOMPILER_H_
+
+#include "AST/ASTNode.h"
+#include "VM/RegisterBytecode.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace suplang {
+
+// The RegisterCompiler class translates an AST into three-address code for the
+// register VM. Name resolution follows the stack Compiler: parameters and
+// names bound inside a function are locals, everything else is global, and
+// functions using a variable of an enclosing function are rejected.
+//
+// Code is first generated over an unbounded set of virtual registers, one per
+// local plus one per temporary, and then handed to AllocateRegisters.
+class RegisterCompiler {
+  public:
+    RegisterProgram compile(ProgramNode *program);
+    // The number of errors reported while compiling; the program must not be
+    // run unless it is zero.
+    size_t errorCount() const { return error_count_; }
+
+  private:
+    // Marks a statement whose completion value is not needed.
+    static constexpr int kNoRegister = -1;
+
+    // Statement compilers. When `dst` is a register, the statement's
+    // completion value is written to it.
+    void compileBlock(const ArenaArray<StatementNode *> &statements, int dst);
+    void compileStatement(StatementNode *node, int dst);
+    void compileIfStatement(IfStatementNode *node, int dst);
+    void compileWhileStatement(WhileStatementNode *node, int dst);
+
+    // Compiles an expression and returns the RK operand holding its value.
+    // `dst` is a hint naming the register the caller would like it in.
+    uint16_t compileExpression(ExpressionNode *node, int dst);
+    uint16_t compileInfixExpression(InfixExpressionNode *node, int dst);
+    // `op` is CALL, or TAIL_CALL for `return f(...)`.
+    uint16_t compileCallExpression(CallExpressionNode *node, int dst, RegOpCode op = RegOpCode::CALL);
+    uint16_t compileFunctionLiteral(FunctionLiteralNode *node);
+    // Compiles an expression whose value must end up in register `dst`.
+    void compileInto(ExpressionNode *node, uint16_t dst);
+    // Emits a jump taken when `condition` is falsy; comparisons are fused
+    // into a single compare-and-branch instruction.
+    size_t compileConditionJump(ExpressionNode *condition);
+
+    // Returns the operand, copied into a fresh temporary if it is a local and
+    // code evaluated before it is consumed may reassign locals.
+    uint16_t protectOperand(uint16_t operand, bool later_assigns);
+    bool isLocalRegister(uint16_t operand) const;
+
+    int localRegister(Symbol name) const;
+    uint16_t globalSlot(Symbol name);
+    uint16_t newRegister();
+    uint16_t integerConstant(int32_t value);
+    uint16_t booleanConstant(bool value);
+    uint16_t nilConstant();
+    uint16_t addConstant(Value value);
+
+    size_t emit(RegOpCode op, uint16_t a = 0, uint16_t b = 0, uint16_t c = 0);
+    void patchJump(size_t index);
+
+    // Per-function compilation state.
+    struct FunctionState {
+        RegisterProto *proto = nullptr;
+        std::map<Symbol, uint16_t> locals;
+        size_t num_locals = 0;
+        size_t num_registers = 0;
+        std::map<int32_t, uint16_t> integer_constants;
+        int bool_constants[2] = {-1, -1};
+        int nil_constant = -1;
+    };
+    FunctionState *state_ = nullptr;
+
+    std::map<Symbol, uint16_t> global_slots_;
+    std::vector<Symbol> global_names_;
+    size_t error_count_ = 0;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_VM_REGISTERCOMPILER_H_
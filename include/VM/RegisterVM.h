@@ -0,0 +1,47 @@
+#ifndef SUPLANG_VM_REGISTERVM_H_
+#define SUPLANG_VM_REGISTERVM_H_
+
+#include "VM/RegisterBytecode.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace suplang {
+
+// A register-based virtual machine that executes the code produced by the
+// RegisterCompiler. Each call owns a window of `num_registers` slots in one
+// contiguous register file.
+class RegisterVM {
+  public:
+    // Runs the program and returns the completion value of its last statement.
+    Value run(const RegisterProgram &program);
+
+    // Retrieves a global variable by name after `run`, or null if unset.
+    Value getGlobal(const std::string &name) const;
+
+    // Number of instructions dispatched by the last `run`.
+    uint64_t instructionCount() const { return instruction_count_; }
+
+  private:
+    struct CallFrame {
+        const RegisterProto *proto;
+        const RegInstruction *pc;
+        size_t base;         // Index of register 0 in the register file.
+        uint16_t return_reg; // Caller register receiving the result.
+    };
+
+    Value execute();
+
+    const RegisterProgram *program_ = nullptr;
+    std::vector<Value> registers_;
+    std::vector<Value> globals_;
+    std::vector<CallFrame> frames_;
+    std::vector<Value> tail_arguments_; // Scratch space for TAIL_CALL.
+    uint64_t instruction_count_ = 0;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_VM_REGISTERVM_H_
@@ -0,0 +1,45 @@
+#ifndef SUPLANG_VM_VM_H_
+#define SUPLANG_VM_VM_H_
+
+#include "VM/Bytecode.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace suplang {
+
+// A stack-based virtual machine that executes the bytecode produced by the
+// Compiler. Locals of each call live in a window of the value stack, directly
+// above the callee.
+class VM {
+  public:
+    // Runs the program and returns the completion value of its last statement.
+    Value run(const CompiledProgram &program);
+
+    // Retrieves a global variable by name after `run`, or null if unset.
+    Value getGlobal(const std::string &name) const;
+
+    // Number of instructions dispatched by the last `run`.
+    uint64_t instructionCount() const { return instruction_count_; }
+
+  private:
+    struct CallFrame {
+        const FunctionProto *proto;
+        const uint8_t *ip;
+        size_t base; // Stack index of local slot 0.
+    };
+
+    Value execute();
+
+    const CompiledProgram *program_ = nullptr;
+    std::vector<Value> stack_;
+    std::vector<Value> globals_;
+    std::vector<CallFrame> frames_;
+    uint64_t instruction_count_ = 0;
+};
+
+} // namespace suplang
+
+#endif // SUPLANG_VM_VM_H_
@@ -0,0 +1,522 @@
+#include "AST/TreeCache.h"
+
+#include "AST/NodeVisitor.h"
+#include "Lexer/SourceBuffer.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace suplang {
+
+namespace {
+
+// The file starts with a fixed header; the payload that follows is the
+// symbol names, the other strings and then the program's statements, in
+// preorder. Integers in the payload are LEB128 varints.
+constexpr char kMagic[4] = {'S', 'L', 'T', 'C'};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t source_size;
+    uint64_t source_hash;
+    uint64_t payload_hash;
+};
+
+// Stands for a null child where a node kind would be.
+constexpr uint8_t kNullTag = 0xFF;
+
+// A 64-bit hash of `data`, eight bytes at a time.
+uint64_t Hash(std::string_view data) {
+    constexpr uint64_t kMultiplier = 0xFF51AFD7ED558CCDull;
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ data.size();
+    size_t i = 0;
+    for (; i + 8 <= data.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data.data() + i, 8);
+        hash = (hash ^ word) * kMultiplier;
+        hash ^= hash >> 29;
+    }
+    // An empty view may have a null data pointer, which memcpy must not get.
+    uint64_t tail = 0;
+    if (i < data.size())
+        std::memcpy(&tail, data.data() + i, data.size() - i);
+    hash = (hash ^ tail) * kMultiplier;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    return hash ^ (hash >> 33);
+}
+
+bool IsExpression(NodeKind kind) {
+    switch (kind) {
+    case NodeKind::INFIX_EXPRESSION:
+    case NodeKind::PREFIX_EXPRESSION:
+    case NodeKind::NUMBER_LITERAL:
+    case NodeKind::BOOLEAN_LITERAL:
+    case NodeKind::IDENTIFIER:
+    case NodeKind::FUNCTION_LITERAL:
+    case NodeKind::CALL_EXPRESSION:
+        return true;
+    default:
+        return false;
+    }
+}
+
+class Encoder {
+  public:
+    // Returns the payload for `program`.
+    std::string encode(const ProgramNode *program) {
+        nodes(program->statements);
+        std::string payload;
+        appendVarint(&payload, symbols_.size());
+        for (Symbol symbol : symbols_) {
+            appendString(&payload, SymbolName(symbol));
+        }
+        appendVarint(&payload, strings_.size());
+        for (std::string_view text : strings_) {
+            appendString(&payload, text);
+        }
+        return payload + out_;
+    }
+
+  private:
+    static void appendVarint(std::string *out, uint64_t value) {
+        while (value >= 0x80) {
+            out->push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out->push_back(static_cast<char>(value));
+    }
+
+    static void appendString(std::string *out, std::string_view text) {
+        appendVarint(out, text.size());
+        out->append(text);
+    }
+
+    void varint(uint64_t value) { appendVarint(&out_, value); }
+    void byte(uint8_t value) { out_.push_back(static_cast<char>(value)); }
+
+    // Index 0 stands for kNoSymbol, and the names follow.
+    void symbol(Symbol symbol) {
+        if (symbol == kNoSymbol) {
+            varint(0);
+            return;
+        }
+        auto [it, inserted] = symbol_index_.try_emplace(symbol, symbols_.size());
+        if (inserted)
+            symbols_.push_back(symbol);
+        varint(it->second + 1);
+    }
+
+    // Lines are stored as the change from the previous location's, zigzag
+    // encoded, which is mostly a single byte.
+    void location(SourceLocation location) {
+        int64_t delta = static_cast<int64_t>(location.line) - last_line_;
+        varint(delta < 0 ? (static_cast<uint64_t>(-delta) << 1) - 1 : static_cast<uint64_t>(delta) << 1);
+        varint(location.column);
+        last_line_ = location.line;
+    }
+
+    void string(std::string_view text) {
+        auto [it, inserted] = string_index_.try_emplace(text, strings_.size());
+        if (inserted)
+            strings_.push_back(text);
+        varint(it->second);
+    }
+
+    template <typename T> void nodes(const ArenaArray<T *> &children) {
+        varint(children.size());
+        for (const ASTNode *child : children) {
+            node(child);
+        }
+    }
+
+    void node(const ASTNode *node) {
+        if (!node) {
+            byte(kNullTag);
+            return;
+        }
+        byte(static_cast<uint8_t>(node->kind));
+        location(node->location);
+        VisitNode<void>(node, Overloaded{
+                                  [&](const ProgramNode *p) { nodes(p->statements); },
+                                  [&](const BlockStatementNode *bs) { nodes(bs->statements); },
+                                  [&](const ExpressionStatementNode *es) { this->node(es->expression); },
+                                  [&](const VarDeclNode *vd) {
+                                      string(vd->varType);
+                                      symbol(vd->varName);
+                                      this->node(vd->initialValue);
+                                  },
+                                  [&](const ReturnStatementNode *rs) { this->node(rs->return_value); },
+                                  [&](const IfStatementNode *is) {
+                                      this->node(is->condition);
+                                      this->node(is->consequence);
+                                      this->node(is->alternative);
+                                  },
+                                  [&](const WhileStatementNode *ws) {
+                                      this->node(ws->condition);
+                                      this->node(ws->body);
+                                  },
+                                  [&](const InfixExpressionNode *ie) {
+                                      byte(static_cast<uint8_t>(ie->op));
+                                      this->node(ie->left);
+                                      this->node(ie->right);
+                                  },
+                                  [&](const PrefixExpressionNode *pe) {
+                                      byte(static_cast<uint8_t>(pe->op));
+                                      this->node(pe->right);
+                                  },
+                                  [&](const NumberLiteralNode *nl) {
+                                      // Zigzag, so that small negative numbers stay short.
+                                      uint32_t value = static_cast<uint32_t>(nl->value);
+                                      varint((value << 1) ^ (nl->value < 0 ? 0xFFFFFFFFu : 0u));
+                                  },
+                                  [&](const BooleanLiteralNode *bl) { byte(bl->value ? 1 : 0); },
+                                  [&](const IdentifierNode *id) { symbol(id->symbol); },
+                                  [&](const FunctionLiteralNode *fl) {
+                                      symbol(fl->name);
+                                      varint(fl->parameters.size());
+                                      for (const Parameter &param : fl->parameters) {
+                                          string(param.type_name);
+                                          symbol(param.param_name);
+                                      }
+                                      bool deferred = fl->isDeferred();
+                                      byte(deferred ? 1 : 0);
+                                      if (deferred) {
+                                          varint(fl->body_offset);
+                                          location(fl->body_location);
+                                      } else {
+                                          this->node(fl->body);
+                                      }
+                                  },
+                                  [&](const CallExpressionNode *ce) {
+                                      this->node(ce->function);
+                                      nodes(ce->arguments);
+                                  },
+                              });
+    }
+
+    std::string out_;
+    uint32_t last_line_ = 0;
+    std::vector<Symbol> symbols_;
+    std::unordered_map<Symbol, size_t> symbol_index_;
+    std::vector<std::string_view> strings_;
+    std::unordered_map<std::string_view, size_t> string_index_;
+};
+
+// Decodes a payload into an arena. Any inconsistency, such as a read past
+// the end or a node of the wrong kind, marks the decoder failed; it then
+// reads zeros and builds nothing more.
+class Decoder {
+  public:
+    Decoder(std::string_view payload, std::string_view source, Arena &arena)
+        : data_(payload), source_(source), arena_(arena) {}
+
+    // Returns the program, or null if the payload is damaged.
+    ProgramNode *decode() {
+        uint64_t symbol_count = count();
+        for (uint64_t i = 0; i < symbol_count && !failed_; ++i) {
+            symbols_.push_back(Intern(text()));
+        }
+        uint64_t string_count = count();
+        for (uint64_t i = 0; i < string_count && !failed_; ++i) {
+            strings_.push_back(arena_.copyString(text()));
+        }
+        auto statements = array<StatementNode>(&Decoder::statement);
+        if (failed_ || position_ != data_.size())
+            return nullptr;
+        return arena_.make<ProgramNode>(statements);
+    }
+
+  private:
+    void fail() { failed_ = true; }
+
+    uint8_t byte() {
+        if (failed_ || position_ >= data_.size()) {
+            fail();
+            return 0;
+        }
+        return static_cast<uint8_t>(data_[position_++]);
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t next = byte();
+            value |= static_cast<uint64_t>(next & 0x7F) << shift;
+            if (!(next & 0x80))
+                return value;
+        }
+        fail();
+        return 0;
+    }
+
+    // A count of things of at least one byte each, so it cannot exceed what
+    // is left of the payload.
+    uint64_t count() {
+        uint64_t value = varint();
+        if (value > data_.size() - position_) {
+            fail();
+            return 0;
+        }
+        return value;
+    }
+
+    std::string_view text() {
+        uint64_t size = count();
+        if (failed_)
+            return {};
+        std::string_view result = data_.substr(position_, size);
+        position_ += size;
+        return result;
+    }
+
+    Symbol symbol() {
+        uint64_t index = varint();
+        if (index > symbols_.size()) {
+            fail();
+            return kNoSymbol;
+        }
+        return index == 0 ? kNoSymbol : symbols_[index - 1];
+    }
+
+    SourceLocation location() {
+        uint64_t zigzag = varint();
+        uint64_t column = varint();
+        int64_t line = zigzag & 1 ? static_cast<int64_t>(last_line_) - static_cast<int64_t>((zigzag + 1) >> 1)
+                                  : static_cast<int64_t>(last_line_) + static_cast<int64_t>(zigzag >> 1);
+        if (zigzag > UINT32_MAX * 2ull || line < 0 || line > UINT32_MAX || column > UINT32_MAX) {
+            fail();
+            return {};
+        }
+        last_line_ = static_cast<uint32_t>(line);
+        return {last_line_, static_cast<uint32_t>(column)};
+    }
+
+    std::string_view string() {
+        uint64_t index = varint();
+        if (index >= strings_.size()) {
+            fail();
+            return {};
+        }
+        return strings_[index];
+    }
+
+    Operator op() {
+        uint8_t value = byte();
+        if (value > static_cast<uint8_t>(Operator::NOT_EQUAL))
+            fail();
+        return static_cast<Operator>(value);
+    }
+
+    // Reads a counted list of children straight into the arena.
+    template <typename T> ArenaArray<T *> array(T *(Decoder::*element)()) {
+        uint64_t size = count();
+        if (failed_ || size == 0)
+            return {};
+        auto data = static_cast<T **>(arena_.allocate(sizeof(T *) * size, alignof(T *)));
+        for (uint64_t i = 0; i < size; ++i) {
+            data[i] = (this->*element)();
+        }
+        return {data, static_cast<size_t>(size)};
+    }
+
+    ExpressionNode *expression() {
+        ASTNode *node = this->node();
+        if (node && !IsExpression(node->kind)) {
+            fail();
+            return nullptr;
+        }
+        return static_cast<ExpressionNode *>(node);
+    }
+
+    StatementNode *statement() {
+        ASTNode *node = this->node();
+        if (node && (IsExpression(node->kind) || node->kind == NodeKind::PROGRAM)) {
+            fail();
+            return nullptr;
+        }
+        return static_cast<StatementNode *>(node);
+    }
+
+    BlockStatementNode *block() {
+        ASTNode *node = this->node();
+        if (node && node->kind != NodeKind::BLOCK_STATEMENT) {
+            fail();
+            return nullptr;
+        }
+        return static_cast<BlockStatementNode *>(node);
+    }
+
+    ASTNode *node() {
+        uint8_t tag = byte();
+        if (failed_ || tag == kNullTag)
+            return nullptr;
+        SourceLocation start = location();
+        ASTNode *node = this->node(static_cast<NodeKind>(tag));
+        if (node)
+            node->location = start;
+        return node;
+    }
+
+    // Reads the fields of a node of `kind`.
+    ASTNode *node(NodeKind kind) {
+        switch (kind) {
+        case NodeKind::BLOCK_STATEMENT:
+            return arena_.make<BlockStatementNode>(array<StatementNode>(&Decoder::statement));
+        case NodeKind::EXPRESSION_STATEMENT:
+            return arena_.make<ExpressionStatementNode>(expression());
+        case NodeKind::VAR_DECL: {
+            std::string_view type = string();
+            Symbol name = symbol();
+            return arena_.make<VarDeclNode>(type, name, expression());
+        }
+        case NodeKind::RETURN_STATEMENT:
+            return arena_.make<ReturnStatementNode>(expression());
+        case NodeKind::IF_STATEMENT: {
+            ExpressionNode *condition = expression();
+            BlockStatementNode *consequence = block();
+            return arena_.make<IfStatementNode>(condition, consequence, statement());
+        }
+        case NodeKind::WHILE_STATEMENT: {
+            ExpressionNode *condition = expression();
+            return arena_.make<WhileStatementNode>(condition, block());
+        }
+        case NodeKind::INFIX_EXPRESSION: {
+            Operator infix = op();
+            ExpressionNode *left = expression();
+            return arena_.make<InfixExpressionNode>(left, infix, expression());
+        }
+        case NodeKind::PREFIX_EXPRESSION: {
+            Operator prefix = op();
+            return arena_.make<PrefixExpressionNode>(prefix, expression());
+        }
+        case NodeKind::NUMBER_LITERAL: {
+            uint64_t zigzag = varint();
+            if (zigzag > UINT32_MAX)
+                fail();
+            uint32_t value = static_cast<uint32_t>(zigzag);
+            return arena_.make<NumberLiteralNode>(static_cast<int32_t>((value >> 1) ^ (0u - (value & 1))));
+        }
+        case NodeKind::BOOLEAN_LITERAL:
+            return arena_.make<BooleanLiteralNode>(byte() != 0);
+        case NodeKind::IDENTIFIER:
+            return arena_.make<IdentifierNode>(symbol());
+        case NodeKind::FUNCTION_LITERAL:
+            return functionLiteral();
+        case NodeKind::CALL_EXPRESSION: {
+            ExpressionNode *function = expression();
+            return arena_.make<CallExpressionNode>(function, array<ExpressionNode>(&Decoder::expression));
+        }
+        default:
+            // A program is never nested; anything else is not a node.
+            fail();
+            return nullptr;
+        }
+    }
+
+    FunctionLiteralNode *functionLiteral() {
+        Symbol name = symbol();
+        uint64_t size = count();
+        if (failed_)
+            return nullptr;
+        auto params = static_cast<Parameter *>(arena_.allocate(sizeof(Parameter) * size, alignof(Parameter)));
+        for (uint64_t i = 0; i < size; ++i) {
+            std::string_view type = string();
+            new (&params[i]) Parameter{type, symbol()};
+        }
+        ArenaArray<Parameter> parameters(size ? params : nullptr, static_cast<size_t>(size));
+        if (byte() != 0) {
+            // The body is parsed from the source on first call.
+            uint64_t body_offset = varint();
+            if (body_offset >= source_.size())
+                fail();
+            SourceLocation body_location = location();
+            auto function =
+                arena_.make<FunctionLiteralNode>(parameters, static_cast<size_t>(body_offset), body_location);
+            function->name = name;
+            return function;
+        }
+        auto function = arena_.make<FunctionLiteralNode>(parameters, block());
+        function->name = name;
+        return function;
+    }
+
+    std::string_view data_;
+    std::string_view source_;
+    Arena &arena_;
+    size_t position_ = 0;
+    uint32_t last_line_ = 0;
+    bool failed_ = false;
+    std::vector<Symbol> symbols_;
+    std::vector<std::string_view> strings_;
+};
+
+} // namespace
+
+std::string TreeCache::Encode(const SyntaxTree &tree, std::string_view source, uint32_t flags) {
+    std::string payload = Encoder().encode(tree.get());
+    Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.flags = flags;
+    header.source_size = source.size();
+    header.source_hash = Hash(source);
+    header.payload_hash = Hash(payload);
+    return std::string(reinterpret_cast<const char *>(&header), sizeof(header)) + payload;
+}
+
+std::unique_ptr<SyntaxTree> TreeCache::Decode(std::string_view data, std::string_view source, uint32_t flags) {
+    Header header;
+    if (data.size() < sizeof(header))
+        return nullptr;
+    std::memcpy(&header, data.data(), sizeof(header));
+    std::string_view payload = data.substr(sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion ||
+        header.flags != flags || header.source_size != source.size() || header.source_hash != Hash(source) ||
+        header.payload_hash != Hash(payload)) {
+        return nullptr;
+    }
+
+    auto arena = std::make_unique<Arena>();
+    ProgramNode *program = Decoder(payload, source, *arena).decode();
+    if (!program)
+        return nullptr;
+    return std::make_unique<SyntaxTree>(std::move(arena), program);
+}
+
+std::unique_ptr<SyntaxTree> TreeCache::Load(const std::string &path, std::string_view source, uint32_t flags) {
+    auto file = SourceBuffer::FromFile(path);
+    if (!file)
+        return nullptr;
+    return Decode(file->text(), source, flags);
+}
+
+bool TreeCache::Store(const std::string &path, std::string_view source, uint32_t flags, const SyntaxTree &tree) {
+    std::string data = Encode(tree, source, flags);
+    // Written beside the final file and renamed over it.
+    std::string temporary = path + ".tmp";
+#if defined(__unix__) || defined(__APPLE__)
+    temporary += "." + std::to_string(getpid());
+#endif
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    // Closing flushes, and sets failbit if that fails.
+    out.close();
+    if (!out || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace suplang
@@ -0,0 +1,330 @@
+#include "Interpreter/ClosureCompiler.h"
+
+#include "AST/NodeVisitor.h"
+#include "Interpreter/ClosureInterpreter.h"
+#include "VM/Locals.h"
+
+namespace suplang {
+
+namespace {
+Closure Constant(Value value) {
+    return [value](ClosureInterpreter &, Value *) { return value; };
+}
+
+// Builds the closure of an integer operator. `op` maps the two integers to
+// the result; any other pair of operands gives null, as in the Interpreter.
+// A literal right operand, the common `i + 1` or `i < 10`, is folded into
+// the closure instead of being evaluated through another call.
+template <typename Op> Closure IntegerOperator(Closure left, Closure right, ExpressionNode *right_node, Op op) {
+    if (auto nl = NodeCast<NumberLiteralNode>(right_node)) {
+        int32_t b = nl->value;
+        return [left = std::move(left), b, op](ClosureInterpreter &interpreter, Value *locals) {
+            Value a = left(interpreter, locals);
+            return a.isInteger() ? op(a.asInteger(), b) : Value();
+        };
+    }
+    return [left = std::move(left), right = std::move(right), op](ClosureInterpreter &interpreter, Value *locals) {
+        // `a` is not rooted while `right` runs; it is only looked at if it is
+        // an integer, which is not a heap object.
+        Value a = left(interpreter, locals);
+        Value b = right(interpreter, locals);
+        return a.isInteger() && b.isInteger() ? op(a.asInteger(), b.asInteger()) : Value();
+    };
+}
+} // namespace
+
+ClosureProgram ClosureCompiler::compile(ProgramNode *program) {
+    ClosureProgram result;
+    for (const auto &stmt : program->statements) {
+        CollectLocals(stmt, &result.global_names);
+    }
+
+    program_ = &result;
+    function_depth_ = 0;
+    Closure statements = compileBlock(program->statements);
+    program_ = nullptr;
+
+    // A top-level return stops the program with its value.
+    result.script = [statements = std::move(statements)](ClosureInterpreter &interpreter, Value *locals) {
+        Value value = statements(interpreter, locals);
+        interpreter.returning_ = false;
+        return value;
+    };
+    return result;
+}
+
+Closure ClosureCompiler::compileNode(ASTNode *node) {
+    if (!node)
+        return Constant(Value());
+
+    return VisitNode<Closure>(
+        node, Overloaded{
+                  [&](ProgramNode *p) { return compileBlock(p->statements); },
+                  [&](BlockStatementNode *bs) { return compileBlock(bs->statements); },
+                  [&](ExpressionStatementNode *es) { return compileNode(es->expression); },
+                  [&](VarDeclNode *vd) { return compileVarDecl(vd); },
+                  [&](ReturnStatementNode *rs) { return compileReturnStatement(rs); },
+                  [&](IfStatementNode *is) { return compileIfStatement(is); },
+                  [&](WhileStatementNode *ws) { return compileWhileStatement(ws); },
+                  [&](InfixExpressionNode *ie) { return compileInfixExpression(ie); },
+                  [&](PrefixExpressionNode *pe) { return compilePrefixExpression(pe); },
+                  [&](NumberLiteralNode *nl) { return Constant(Value::Integer(nl->value)); },
+                  [&](BooleanLiteralNode *bl) { return Constant(Value::Boolean(bl->value)); },
+                  [&](IdentifierNode *id) { return compileIdentifier(id); },
+                  [&](FunctionLiteralNode *fl) { return compileFunctionLiteral(fl); },
+                  [&](CallExpressionNode *ce) { return compileCallExpression(ce); },
+              });
+}
+
+Closure ClosureCompiler::compileBlock(const ArenaArray<StatementNode *> &statements) {
+    if (statements.empty())
+        return Constant(Value());
+    if (statements.size() == 1)
+        return compileNode(statements[0]);
+
+    std::vector<Closure> compiled;
+    for (const auto &stmt : statements) {
+        compiled.push_back(compileNode(stmt));
+    }
+    return [compiled = std::move(compiled)](ClosureInterpreter &interpreter, Value *locals) {
+        Value result;
+        for (const auto &stmt : compiled) {
+            result = stmt(interpreter, locals);
+            // A return statement stops the block and passes its value up.
+            if (interpreter.returning_)
+                return result;
+        }
+        return result;
+    };
+}
+
+Closure ClosureCompiler::compileVarDecl(VarDeclNode *node) {
+    size_t slot = node->slot;
+    if (node->captured) {
+        return [value = compileNode(node->initialValue), slot](ClosureInterpreter &interpreter, Value *locals) {
+            Value result = value(interpreter, locals);
+            if (!result.isNil()) {
+                AsCell(locals[slot])->value = result;
+            }
+            return result;
+        };
+    }
+    return [value = compileNode(node->initialValue), slot](ClosureInterpreter &interpreter, Value *locals) {
+        Value result = value(interpreter, locals);
+        if (!result.isNil()) {
+            locals[slot] = result;
+        }
+        return result;
+    };
+}
+
+Closure ClosureCompiler::compileReturnStatement(ReturnStatementNode *node) {
+    // `return f(...)` inside a function is a tail call, run by the enclosing
+    // applyFunction in place of the returning body.
+    auto call = NodeCast<CallExpressionNode>(node->return_value);
+    if (call && function_depth_ > 0) {
+        std::vector<Closure> arguments;
+        for (const auto &arg : call->arguments) {
+            arguments.push_back(compileNode(arg));
+        }
+        return [function = compileNode(call->function),
+                arguments = std::move(arguments)](ClosureInterpreter &interpreter, Value *locals) {
+            size_t callee = interpreter.temps_.size();
+            if (interpreter.pushCall(function, arguments, locals)) {
+                interpreter.tail_call_ = callee;
+            }
+            // Set only now: calls made by the arguments clear the flag.
+            interpreter.returning_ = true;
+            return Value();
+        };
+    }
+
+    return [value = compileNode(node->return_value)](ClosureInterpreter &interpreter, Value *locals) {
+        Value result = value(interpreter, locals);
+        interpreter.returning_ = true;
+        return result;
+    };
+}
+
+Closure ClosureCompiler::compileIfStatement(IfStatementNode *node) {
+    Closure condition = compileNode(node->condition);
+    Closure consequence = compileNode(node->consequence);
+    if (!node->alternative) {
+        return [condition = std::move(condition),
+                consequence = std::move(consequence)](ClosureInterpreter &interpreter, Value *locals) {
+            return condition(interpreter, locals).isTruthy() ? consequence(interpreter, locals) : Value();
+        };
+    }
+    return [condition = std::move(condition), consequence = std::move(consequence),
+            alternative = compileNode(node->alternative)](ClosureInterpreter &interpreter, Value *locals) {
+        return condition(interpreter, locals).isTruthy() ? consequence(interpreter, locals)
+                                                         : alternative(interpreter, locals);
+    };
+}
+
+Closure ClosureCompiler::compileWhileStatement(WhileStatementNode *node) {
+    return [condition = compileNode(node->condition),
+            body = compileNode(node->body)](ClosureInterpreter &interpreter, Value *locals) {
+        Value result;
+        for (;;) {
+            // The body's value is the loop's result, so an object must
+            // survive the condition check.
+            bool rooted = result.isObject();
+            if (rooted)
+                interpreter.temps_.push_back(result);
+            bool more = condition(interpreter, locals).isTruthy();
+            if (rooted)
+                interpreter.temps_.pop_back();
+            if (!more)
+                return result;
+
+            result = body(interpreter, locals);
+            if (interpreter.returning_)
+                return result;
+        }
+    };
+}
+
+Closure ClosureCompiler::compileInfixExpression(InfixExpressionNode *node) {
+    if (node->op == Operator::ASSIGN) {
+        Closure right = compileNode(node->right);
+        if (auto id = NodeCast<IdentifierNode>(node->left)) {
+            // Assignment targets are always bound in the current scope.
+            size_t slot = id->slot;
+            if (id->variable == VariableKind::CELL) {
+                return [right = std::move(right), slot](ClosureInterpreter &interpreter, Value *locals) {
+                    Value value = right(interpreter, locals);
+                    AsCell(locals[slot])->value = value;
+                    return value;
+                };
+            }
+            return [right = std::move(right), slot](ClosureInterpreter &interpreter, Value *locals) {
+                Value value = right(interpreter, locals);
+                locals[slot] = value;
+                return value;
+            };
+        }
+        // Assignment to something other than a name evaluates the value once
+        // and then both operands, and produces null.
+        return [left = compileNode(node->left), right = std::move(right)](ClosureInterpreter &interpreter,
+                                                                           Value *locals) {
+            right(interpreter, locals);
+            left(interpreter, locals);
+            right(interpreter, locals);
+            return Value();
+        };
+    }
+
+    Closure left = compileNode(node->left);
+    Closure right = compileNode(node->right);
+    switch (node->op) {
+    case Operator::ADD:
+        return IntegerOperator(std::move(left), std::move(right), node->right,
+                               [](uint32_t a, uint32_t b) { return Value::Integer(Wrap(a + b)); });
+    case Operator::SUBTRACT:
+        return IntegerOperator(std::move(left), std::move(right), node->right,
+                               [](uint32_t a, uint32_t b) { return Value::Integer(Wrap(a - b)); });
+    case Operator::MULTIPLY:
+        return IntegerOperator(std::move(left), std::move(right), node->right,
+                               [](uint32_t a, uint32_t b) { return Value::Integer(Wrap(a * b)); });
+    case Operator::DIVIDE:
+        return IntegerOperator(std::move(left), std::move(right), node->right,
+                               [](int32_t a, int32_t b) { return Value::Integer(Divide(a, b)); });
+    case Operator::LESS:
+        return IntegerOperator(std::move(left), std::move(right), node->right,
+                               [](int32_t a, int32_t b) { return Value::Boolean(a < b); });
+    case Operator::GREATER:
+        return IntegerOperator(std::move(left), std::move(right), node->right,
+                               [](int32_t a, int32_t b) { return Value::Boolean(a > b); });
+    case Operator::EQUAL:
+        return IntegerOperator(std::move(left), std::move(right), node->right,
+                               [](int32_t a, int32_t b) { return Value::Boolean(a == b); });
+    case Operator::NOT_EQUAL:
+        return IntegerOperator(std::move(left), std::move(right), node->right,
+                               [](int32_t a, int32_t b) { return Value::Boolean(a != b); });
+    case Operator::ASSIGN:
+        break;
+    }
+    return Constant(Value());
+}
+
+Closure ClosureCompiler::compilePrefixExpression(PrefixExpressionNode *node) {
+    Closure right = compileNode(node->right);
+    if (node->op != Operator::SUBTRACT) {
+        return [right = std::move(right)](ClosureInterpreter &interpreter, Value *locals) {
+            right(interpreter, locals);
+            return Value();
+        };
+    }
+    return [right = std::move(right)](ClosureInterpreter &interpreter, Value *locals) {
+        Value value = right(interpreter, locals);
+        return value.isInteger() ? Value::Integer(Wrap(0u - static_cast<uint32_t>(value.asInteger()))) : Value();
+    };
+}
+
+Closure ClosureCompiler::compileIdentifier(IdentifierNode *node) {
+    size_t slot = node->slot;
+    switch (node->variable) {
+    case VariableKind::LOCAL:
+        return [slot](ClosureInterpreter &, Value *locals) { return locals[slot]; };
+    case VariableKind::CELL:
+        return [slot](ClosureInterpreter &, Value *locals) { return AsCell(locals[slot])->value; };
+    case VariableKind::UPVALUE:
+        return [slot](ClosureInterpreter &interpreter, Value *) {
+            return interpreter.frames_.back().function->upvalues[slot]->value;
+        };
+    case VariableKind::GLOBAL:
+        return [slot](ClosureInterpreter &interpreter, Value *) { return interpreter.globals_->get(slot); };
+    case VariableKind::UNBOUND:
+        break;
+    }
+    return Constant(Value());
+}
+
+Closure ClosureCompiler::compileFunctionLiteral(FunctionLiteralNode *node) {
+    auto function = std::make_unique<ClosureFunction>();
+    function->arity = node->parameters.size();
+    function->num_locals = node->num_locals;
+    function->captured_slots.assign(node->captured_slots.begin(), node->captured_slots.end());
+    function->upvalues.assign(node->upvalues.begin(), node->upvalues.end());
+    ++function_depth_;
+    function->body = node->body ? compileNode(node->body) : Constant(Value());
+    --function_depth_;
+
+    const ClosureFunction *code = function.get();
+    program_->functions.push_back(std::move(function));
+    // A new closure captures the Cells of the variables it uses from the
+    // enclosing calls, as in the Interpreter.
+    if (code->upvalues.empty()) {
+        return [code](ClosureInterpreter &interpreter, Value *) {
+            return Value::FromObject(interpreter.heap_.allocate<ClosureFunctionObject>(code));
+        };
+    }
+    return [code](ClosureInterpreter &interpreter, Value *locals) {
+        auto fn = interpreter.heap_.allocate<ClosureFunctionObject>(code);
+        fn->upvalues.reserve(code->upvalues.size());
+        for (const UpvalueRef &ref : code->upvalues) {
+            fn->upvalues.push_back(ref.from_local ? AsCell(locals[ref.index])
+                                                  : interpreter.frames_.back().function->upvalues[ref.index]);
+        }
+        return Value::FromObject(fn);
+    };
+}
+
+Closure ClosureCompiler::compileCallExpression(CallExpressionNode *node) {
+    std::vector<Closure> arguments;
+    for (const auto &arg : node->arguments) {
+        arguments.push_back(compileNode(arg));
+    }
+    return [function = compileNode(node->function),
+            arguments = std::move(arguments)](ClosureInterpreter &interpreter, Value *locals) {
+        size_t callee = interpreter.temps_.size();
+        if (!interpreter.pushCall(function, arguments, locals))
+            return Value();
+        Value result = interpreter.applyFunction(callee, arguments.size());
+        interpreter.temps_.resize(callee);
+        return result;
+    };
+}
+
+} // namespace suplang
@@ -0,0 +1,86 @@
+#include "Interpreter/ClosureInterpreter.h"
+
+#include <algorithm>
+
+namespace suplang {
+
+ClosureInterpreter::ClosureInterpreter(GcOptions gc_options) : heap_(gc_options) {
+    globals_ = heap_.allocate<Environment>();
+    heap_.setRootMarker([this](Heap &heap) { markRoots(heap); });
+}
+
+void ClosureInterpreter::markRoots(Heap &heap) {
+    heap.markObject(globals_);
+    for (const Frame &frame : frames_) {
+        for (size_t i = 0; i < frame.size; ++i) {
+            heap.markValue(frame.locals[i]);
+        }
+        heap.markObject(frame.function);
+    }
+    for (const Value &value : temps_) {
+        heap.markValue(value);
+    }
+}
+
+Value ClosureInterpreter::run(const ClosureProgram &program) {
+    globals_->declare(program.global_names);
+    return program.script(*this, globals_->data());
+}
+
+bool ClosureInterpreter::pushCall(const Closure &function, const std::vector<Closure> &arguments, Value *locals) {
+    // The callee and the arguments wait on the temporary stack, where the
+    // collector can see them, until the call is made.
+    Value callee = function(*this, locals);
+    if (callee.isNil())
+        return false;
+    temps_.push_back(callee);
+    for (const auto &argument : arguments) {
+        Value value = argument(*this, locals);
+        temps_.push_back(value);
+    }
+    return true;
+}
+
+Value ClosureInterpreter::applyFunction(size_t callee, size_t argc) {
+    for (;;) {
+        const Value &fn = temps_[callee];
+        if (!fn.isObject() || fn.asObject()->type != ObjectType::CLOSURE_FUNCTION) {
+            // Trying to call a non-function.
+            return Value();
+        }
+        auto fn_obj = static_cast<ClosureFunctionObject *>(fn.asObject());
+        const ClosureFunction *function = fn_obj->function;
+
+        // A frame on the value stack with the arguments bound to the
+        // parameter slots. Missing arguments leave their parameters null.
+        Value *locals = stack_.push(function->num_locals);
+        for (size_t i = 0; i < function->arity && i < argc; ++i) {
+            locals[i] = temps_[callee + 1 + i];
+        }
+
+        frames_.push_back({locals, function->num_locals, fn_obj});
+        // Captured variables move into Cells once the frame is rooted.
+        for (size_t slot : function->captured_slots) {
+            auto cell = heap_.allocate<Cell>(locals[slot]);
+            locals[slot] = Value::FromObject(cell);
+        }
+        Value result = function->body(*this, locals);
+        frames_.pop_back();
+        stack_.pop(locals);
+
+        // Whether the body returned or ran off its end, the call is over.
+        returning_ = false;
+        if (tail_call_ == kNoTailCall)
+            return result;
+
+        // The body ended in a tail call: its callee and arguments replace
+        // ours on the temporary stack and the loop makes the call.
+        size_t next = tail_call_;
+        tail_call_ = kNoTailCall;
+        argc = temps_.size() - next - 1;
+        std::move(temps_.begin() + next, temps_.end(), temps_.begin() + callee);
+        temps_.resize(callee + 1 + argc);
+    }
+}
+
+} // namespace suplang
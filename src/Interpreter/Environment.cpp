@@ -2,13 +2,18 @@
 
 namespace suplang {
 
-std::shared_ptr<Object> Environment::get(const std::string &name) {
-    if (store_.count(name)) {
-        return store_[name];
-    }
-    return nullptr; // Return null if the variable is not found.
+void Environment::declare(const std::vector<Symbol> &names) {
+    names_ = names;
+    slots_.assign(names.size(), Value());
 }
 
-void Environment::set(const std::string &name, std::shared_ptr<Object> value) { store_[name] = value; }
+Value Environment::get(const std::string &name) const {
+    Symbol symbol = SymbolTable::Global().find(name);
+    for (size_t i = 0; i < names_.size(); ++i) {
+        if (names_[i] == symbol)
+            return slots_[i];
+    }
+    return Value(); // Return null if the variable is not found.
+}
 
-} // namespace suplang
\ No newline at end of file
+} // namespace suplang
@@ -1,7 +1,10 @@
 #include "Interpreter/Interpreter.h"
 
-// This .cpp file needs the full definition of all Object types to perform
-// dynamic casts and access member variables.
+#include "AST/NodeVisitor.h"
+#include "VM/Locals.h"
+
+// This .cpp file needs the full definition of all Object types to access
+// member variables.
 #include "Object/Object.h"
 
 #include <iostream>
@@ -9,228 +12,420 @@
 namespace suplang {
 
 namespace {
-// Helper function to determine if an object is "truthy" in a boolean context.
-// In our language, only the boolean value `false` is falsy.
-// Everything else (including the number 0) is considered truthy.
-bool IsTruthy(std::shared_ptr<Object> obj) {
-    if (!obj)
-        return false;
-    if (auto b = std::dynamic_pointer_cast<BooleanObject>(obj)) {
-        return b->value;
+// Whether every parameter the TypeChecker typed gets an argument of its type.
+bool ArgumentsConform(const ArenaArray<Parameter> &parameters, const Value *args, size_t argc) {
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        StaticType type = parameters[i].static_type;
+        if (type == StaticType::DYNAMIC)
+            continue;
+        if (i >= argc || (type == StaticType::INT32 ? !args[i].isInteger() : !args[i].isBoolean()))
+            return false;
     }
     return true;
 }
 } // namespace
 
-// The main dispatch function for evaluation. It uses dynamic_cast to
-// determine the node type and call the appropriate evaluation method.
-std::shared_ptr<Object> Interpreter::eval(ASTNode *node, std::shared_ptr<Environment> env) {
-    if (!node)
-        return nullptr;
-
-    if (auto p = dynamic_cast<ProgramNode *>(node))
-        return evalProgram(p, env);
-    if (auto bs = dynamic_cast<BlockStatementNode *>(node))
-        return evalBlockStatement(bs, env);
-    if (auto es = dynamic_cast<ExpressionStatementNode *>(node))
-        return eval(es->expression.get(), env);
-    if (auto vd = dynamic_cast<VarDeclNode *>(node))
-        return evalVarDecl(vd, env);
-    if (auto rs = dynamic_cast<ReturnStatementNode *>(node))
-        return evalReturnStatement(rs, env);
-    if (auto is = dynamic_cast<IfStatementNode *>(node))
-        return evalIfStatement(is, env);
-    if (auto ws = dynamic_cast<WhileStatementNode *>(node))
-        return evalWhileStatement(ws, env);
-    if (auto ie = dynamic_cast<InfixExpressionNode *>(node))
-        return evalInfixExpression(ie, env);
-    if (auto pe = dynamic_cast<PrefixExpressionNode *>(node))
-        return evalPrefixExpression(pe, env);
-
-    // Evaluate expressions.
-    if (auto nl = dynamic_cast<NumberLiteralNode *>(node)) {
-        return std::make_shared<IntegerObject>(nl->value);
-    }
-    if (auto bl = dynamic_cast<BooleanLiteralNode *>(node)) {
-        return std::make_shared<BooleanObject>(bl->value);
-    }
-    if (auto id = dynamic_cast<IdentifierNode *>(node)) {
-        return env->get(id->value);
-    }
-    if (auto fl = dynamic_cast<FunctionLiteralNode *>(node)) {
-        // When a function is defined, capture the current environment `env`.
-        // This is how closures work.
-        return std::make_shared<FunctionObject>(fl->parameters, std::move(fl->body), env);
-    }
-    if (auto ce = dynamic_cast<CallExpressionNode *>(node)) {
-        // Evaluate the function identifier/literal to get a FunctionObject.
-        auto function = eval(ce->function.get(), env);
-        if (!function)
-            return nullptr;
-
-        // Evaluate all arguments passed to the function.
-        std::vector<std::shared_ptr<Object>> args;
-        for (const auto &arg_node : ce->arguments) {
-            args.push_back(eval(arg_node.get(), env));
+Interpreter::Interpreter(GcOptions gc_options) : heap_(gc_options) {
+    globals_ = heap_.allocate<Environment>();
+    heap_.setRootMarker([this](Heap &heap) { markRoots(heap); });
+}
+
+void Interpreter::markRoots(Heap &heap) {
+    heap.markObject(globals_);
+    for (const Frame &frame : frames_) {
+        for (size_t i = 0; i < frame.size; ++i) {
+            heap.markValue(frame.locals[i]);
         }
-        return applyFunction(function, args);
+        heap.markObject(frame.function);
+    }
+    for (const Value &value : temps_) {
+        heap.markValue(value);
+    }
+}
+
+Value Interpreter::eval(const ASTNode *node) {
+    halted_ = false;
+    auto result = eval(node, globals_->data());
+    returning_ = false;
+    return result;
+}
+
+// The main dispatch function for evaluation. A single switch on the node's
+// kind selects the evaluation method for its concrete type.
+Value Interpreter::eval(const ASTNode *node, Value *locals) {
+    if (!node)
+        return Value();
+
+    return VisitNode<Value>(
+        node, Overloaded{
+                  [&](const ProgramNode *p) { return evalProgram(p); },
+                  [&](const BlockStatementNode *bs) { return evalBlockStatement(bs, locals); },
+                  [&](const ExpressionStatementNode *es) { return eval(es->expression, locals); },
+                  [&](const VarDeclNode *vd) { return evalVarDecl(vd, locals); },
+                  [&](const ReturnStatementNode *rs) { return evalReturnStatement(rs, locals); },
+                  [&](const IfStatementNode *is) { return evalIfStatement(is, locals); },
+                  [&](const WhileStatementNode *ws) { return evalWhileStatement(ws, locals); },
+                  [&](const InfixExpressionNode *ie) { return evalInfixExpression(ie, locals); },
+                  [&](const PrefixExpressionNode *pe) { return evalPrefixExpression(pe, locals); },
+                  [&](const NumberLiteralNode *nl) { return Value::Integer(nl->value); },
+                  [&](const BooleanLiteralNode *bl) { return Value::Boolean(bl->value); },
+                  [&](const IdentifierNode *id) { return evalIdentifier(id, locals); },
+                  [&](const FunctionLiteralNode *fl) { return evalFunctionLiteral(fl, locals); },
+                  [&](const CallExpressionNode *ce) { return evalCallExpression(ce, locals); },
+              });
+}
+
+bool Interpreter::pushCall(const CallExpressionNode *node, Value *locals) {
+    // Evaluate the function identifier/literal to get a FunctionObject. It
+    // and the arguments wait on the temporary stack, where the collector
+    // can see them, until the call is made.
+    auto function = eval(node->function, locals);
+    if (function.isNil())
+        return false;
+    temps_.push_back(function);
+
+    // Evaluate all arguments passed to the function.
+    for (const auto &arg_node : node->arguments) {
+        auto arg = eval(arg_node, locals);
+        temps_.push_back(arg);
     }
+    return true;
+}
 
-    return nullptr;
+Value Interpreter::evalCallExpression(const CallExpressionNode *node, Value *locals) {
+    size_t callee = temps_.size();
+    if (!pushCall(node, locals))
+        return Value();
+    auto result = applyFunction(callee, node->arguments.size());
+    temps_.resize(callee);
+    return result;
 }
 
-std::shared_ptr<Object> Interpreter::evalProgram(ProgramNode *node, std::shared_ptr<Environment> env) {
-    std::shared_ptr<Object> result;
+Value Interpreter::evalProgram(const ProgramNode *node) {
+    // Lay the top-level environment out as the Resolver numbered its slots.
+    std::vector<Symbol> names;
+    for (const auto &stmt : node->statements) {
+        CollectLocals(stmt, &names);
+    }
+    globals_->declare(names);
+    Value *locals = globals_->data();
+
+    Value result;
     for (const auto &stmt : node->statements) {
-        result = eval(stmt.get(), env);
-        // If a return statement is encountered, stop execution and propagate
-        // the return value up.
-        if (result && result->type == ObjectType::RETURN_VALUE) {
-            return std::dynamic_pointer_cast<ReturnValueObject>(result)->value;
+        if (profiler_)
+            profiler_->enterStatement(stmt);
+        result = eval(stmt, locals);
+        if (profiler_)
+            profiler_->leaveStatement();
+        // A top-level return stops the program with its value.
+        if (returning_) {
+            returning_ = false;
+            return result;
         }
     }
     return result;
 }
 
-std::shared_ptr<Object> Interpreter::evalBlockStatement(BlockStatementNode *node, std::shared_ptr<Environment> env) {
-    std::shared_ptr<Object> result;
+Value Interpreter::evalIdentifier(const IdentifierNode *node, Value *locals) {
+    switch (node->variable) {
+    case VariableKind::LOCAL:
+        return locals[node->slot];
+    case VariableKind::CELL:
+        return AsCell(locals[node->slot])->value;
+    case VariableKind::UPVALUE:
+        return frames_.back().function->upvalues[node->slot]->value;
+    case VariableKind::GLOBAL:
+        return globals_->get(node->slot);
+    case VariableKind::UNBOUND:
+        break;
+    }
+    return Value();
+}
+
+Value Interpreter::evalFunctionLiteral(const FunctionLiteralNode *node, Value *locals) {
+    // The new closure captures the Cells of the variables it uses from the
+    // enclosing calls: from the current call's slots, or passed on from the
+    // current function's own upvalues.
+    auto fn = heap_.allocate<FunctionObject>(node);
+    if (node->isDeferred()) {
+        // Only top-level functions are deferred, and those capture nothing.
+        // The body is compiled once it has been loaded.
+        fn->jit_pending = jit_enabled_;
+        return Value::FromObject(fn);
+    }
+
+    fn->upvalues.reserve(node->upvalues.size());
+    for (const UpvalueRef &ref : node->upvalues) {
+        fn->upvalues.push_back(ref.from_local ? AsCell(locals[ref.index])
+                                              : frames_.back().function->upvalues[ref.index]);
+    }
+    if (jit_enabled_)
+        fn->jit = jitFunction(node);
+    return Value::FromObject(fn);
+}
+
+Value Interpreter::evalBlockStatement(const BlockStatementNode *node, Value *locals) {
+    Value result;
     for (const auto &stmt : node->statements) {
-        result = eval(stmt.get(), env);
-        // If a return object is found, we must stop evaluation of the block
-        // and propagate it upwards.
-        if (result && result->type == ObjectType::RETURN_VALUE) {
+        if (profiler_)
+            profiler_->enterStatement(stmt);
+        result = eval(stmt, locals);
+        if (profiler_)
+            profiler_->leaveStatement();
+        // If a return statement ran, we must stop evaluation of the block
+        // and propagate its value upwards.
+        if (returning_) {
             return result;
         }
     }
     return result;
 }
 
-std::shared_ptr<Object> Interpreter::evalWhileStatement(WhileStatementNode *node, std::shared_ptr<Environment> env) {
-    std::shared_ptr<Object> result = nullptr;
-    auto condition = eval(node->condition.get(), env);
+Value Interpreter::evalWhileStatement(const WhileStatementNode *node, Value *locals) {
+    Value result;
+    auto condition = eval(node->condition, locals);
 
-    while (IsTruthy(condition)) {
-        result = eval(node->body.get(), env);
+    while (condition.isTruthy() && !halted_) {
+        result = eval(node->body, locals);
         // If a return statement is executed inside the loop, break out.
-        if (result && result->type == ObjectType::RETURN_VALUE) {
+        if (returning_) {
             return result;
         }
-        // Re-evaluate the condition for the next iteration.
-        condition = eval(node->condition.get(), env);
+        // Re-evaluate the condition for the next iteration. The body's value
+        // is the loop's result, so it must survive the condition.
+        temps_.push_back(result);
+        condition = eval(node->condition, locals);
+        temps_.pop_back();
     }
     return result;
 }
 
-std::shared_ptr<Object> Interpreter::evalReturnStatement(ReturnStatementNode *node, std::shared_ptr<Environment> env) {
-    auto val = eval(node->return_value.get(), env);
-    // Wrap the actual return value in a special ReturnValueObject to signal
-    // that the function should stop executing.
-    return std::make_shared<ReturnValueObject>(val);
+Value Interpreter::evalReturnStatement(const ReturnStatementNode *node, Value *locals) {
+    // `return f(...)` inside a function is a tail call: rather than calling
+    // `f` from here, leave it and its arguments on the temporary stack and
+    // let the current call's applyFunction run it in place of the body that
+    // is returning. Deep tail recursion then runs in constant native stack.
+    auto call = NodeCast<CallExpressionNode>(node->return_value);
+    if (call && !frames_.empty()) {
+        size_t callee = temps_.size();
+        if (pushCall(call, locals)) {
+            tail_call_ = callee;
+        }
+        // Set only now: calls made by the arguments clear the flag.
+        returning_ = true;
+        return Value();
+    }
+
+    auto val = eval(node->return_value, locals);
+    // Signal that the function should stop executing; the enclosing blocks
+    // pass the value up unchanged until the call consumes the flag.
+    returning_ = true;
+    return val;
 }
 
-std::shared_ptr<Object> Interpreter::applyFunction(std::shared_ptr<Object> fn,
-                                                   const std::vector<std::shared_ptr<Object>> &args) {
-    if (fn->type != ObjectType::FUNCTION) {
-        // Handle error: trying to call a non-function.
-        return nullptr;
-    }
-    auto fn_obj = std::dynamic_pointer_cast<FunctionObject>(fn);
+Value Interpreter::applyFunction(size_t callee, size_t argc) {
+    for (;;) {
+        if (halted_)
+            return Value();
+        const Value &fn = temps_[callee];
+        if (!fn.isObject() || fn.asObject()->type != ObjectType::FUNCTION) {
+            // Handle error: trying to call a non-function.
+            return Value();
+        }
+        auto fn_obj = static_cast<FunctionObject *>(fn.asObject());
+        const FunctionLiteralNode *literal = fn_obj->literal;
+        if (literal->isDeferred()) {
+            if (!lazy_functions_) {
+                std::cerr << "Runtime Error: Function body was not parsed.\n";
+                return Value();
+            }
+            if (!lazy_functions_->load(literal)) {
+                halted_ = true;
+                returning_ = true;
+                return Value();
+            }
+        }
+        if (fn_obj->jit_pending) {
+            fn_obj->jit = jitFunction(literal);
+            fn_obj->jit_pending = false;
+        }
 
-    // Create a new, extended environment for the function call.
-    auto extended_env = extendFunctionEnv(fn_obj.get(), args);
+        if (profiler_)
+            profiler_->enterFunction(literal);
 
-    // Evaluate the function body within this new, temporary environment.
-    auto evaluated = eval(fn_obj->body.get(), extended_env);
+        // Native code runs the whole call; it makes no calls of its own.
+        Value native;
+        if (fn_obj->jit && fn_obj->jit->call(temps_.data() + callee + 1, argc, &native)) {
+            if (profiler_)
+                profiler_->leaveFunction();
+            return native;
+        }
 
-    // If the evaluation of the body resulted in a return statement, we
-    // "unwrap" the value to get the actual return object.
-    if (evaluated && evaluated->type == ObjectType::RETURN_VALUE) {
-        return std::dynamic_pointer_cast<ReturnValueObject>(evaluated)->value;
-    }
-    return evaluated;
-}
+        // The call's slots live on the value stack, with the arguments bound
+        // to the parameter slots, which come first. Missing arguments leave
+        // their parameters null.
+        Value *locals = stack_.push(literal->num_locals);
+        for (size_t i = 0; i < literal->parameters.size() && i < argc; ++i) {
+            locals[i] = temps_[callee + 1 + i];
+        }
+        frames_.push_back({locals, literal->num_locals, fn_obj});
+        // Captured variables move into Cells once the frame is rooted.
+        for (size_t slot : literal->captured_slots) {
+            auto cell = heap_.allocate<Cell>(locals[slot]);
+            locals[slot] = Value::FromObject(cell);
+        }
+
+        // Its static types assume arguments of the declared types.
+        bool typed = typed_;
+        typed_ = ArgumentsConform(literal->parameters, temps_.data() + callee + 1, argc);
+        auto evaluated = eval(literal->body, locals);
+        typed_ = typed;
+        frames_.pop_back();
+        stack_.pop(locals);
+        if (profiler_)
+            profiler_->leaveFunction();
 
-std::shared_ptr<Environment> Interpreter::extendFunctionEnv(FunctionObject *fn,
-                                                            const std::vector<std::shared_ptr<Object>> &args) {
-    // Create a new environment that is enclosed by the function's definition
-    // environment (`fn->env`). This is crucial for closures.
-    auto env = std::make_shared<Environment>(fn->env);
+        // Whether the body returned or ran off its end, the call is over,
+        // unless the run is stopping.
+        returning_ = halted_;
+        if (tail_call_ == kNoTailCall)
+            return evaluated;
 
-    // Bind the arguments to the parameter names in the new environment.
-    for (size_t i = 0; i < fn->parameters.size(); ++i) {
-        env->set(fn->parameters[i].param_name, args[i]);
+        // The body ended in a tail call: its callee and arguments replace
+        // ours on the temporary stack and the loop makes the call.
+        size_t next = tail_call_;
+        tail_call_ = kNoTailCall;
+        argc = temps_.size() - next - 1;
+        std::move(temps_.begin() + next, temps_.end(), temps_.begin() + callee);
+        temps_.resize(callee + 1 + argc);
     }
-    return env;
 }
 
-std::shared_ptr<Object> Interpreter::evalVarDecl(VarDeclNode *node, std::shared_ptr<Environment> env) {
-    auto value = eval(node->initialValue.get(), env);
-    if (value) {
-        env->set(node->varName, value);
+const JitFunction *Interpreter::jitFunction(const FunctionLiteralNode *node) {
+    auto [it, inserted] = jit_code_.try_emplace(node);
+    if (inserted)
+        it->second = JitCompiler::compile(node->parameters, node->body, node->num_locals);
+    return it->second.get();
+}
+
+Value Interpreter::evalVarDecl(const VarDeclNode *node, Value *locals) {
+    auto value = eval(node->initialValue, locals);
+    if (!value.isNil()) {
+        if (node->captured) {
+            AsCell(locals[node->slot])->value = value;
+        } else {
+            locals[node->slot] = value;
+        }
     }
     return value;
 }
 
-std::shared_ptr<Object> Interpreter::evalIfStatement(IfStatementNode *node, std::shared_ptr<Environment> env) {
-    auto condition = eval(node->condition.get(), env);
-    if (IsTruthy(condition)) {
-        return eval(node->consequence.get(), env);
+Value Interpreter::evalIfStatement(const IfStatementNode *node, Value *locals) {
+    auto condition = eval(node->condition, locals);
+    if (condition.isTruthy()) {
+        return eval(node->consequence, locals);
     } else if (node->alternative) {
-        return eval(node->alternative.get(), env);
+        return eval(node->alternative, locals);
     }
-    return nullptr;
+    return Value();
 }
 
-std::shared_ptr<Object> Interpreter::evalInfixExpression(InfixExpressionNode *node, std::shared_ptr<Environment> env) {
-    if (node->op == "=") {
-        auto right_val = eval(node->right.get(), env);
-        if (auto id = dynamic_cast<IdentifierNode *>(node->left.get())) {
-            env->set(id->value, right_val);
+Value Interpreter::evalInfixExpression(const InfixExpressionNode *node, Value *locals) {
+    if (node->op == Operator::ASSIGN) {
+        auto right_val = eval(node->right, locals);
+        if (auto id = NodeCast<IdentifierNode>(node->left)) {
+            // Assignment targets are always bound in the current scope.
+            if (id->variable == VariableKind::CELL) {
+                AsCell(locals[id->slot])->value = right_val;
+            } else {
+                locals[id->slot] = right_val;
+            }
             return right_val;
         }
     }
 
-    auto left = eval(node->left.get(), env);
-    auto right = eval(node->right.get(), env);
-    if (!left || !right)
-        return nullptr;
-
-    if (left->type == ObjectType::INTEGER && right->type == ObjectType::INTEGER) {
-        auto left_val = std::dynamic_pointer_cast<IntegerObject>(left)->value;
-        auto right_val = std::dynamic_pointer_cast<IntegerObject>(right)->value;
-
-        if (node->op == "+")
-            return std::make_shared<IntegerObject>(left_val + right_val);
-        if (node->op == "-")
-            return std::make_shared<IntegerObject>(left_val - right_val);
-        if (node->op == "*")
-            return std::make_shared<IntegerObject>(left_val * right_val);
-        if (node->op == "/")
-            return std::make_shared<IntegerObject>(left_val / right_val);
-        if (node->op == ">")
-            return std::make_shared<BooleanObject>(left_val > right_val);
-        if (node->op == "<")
-            return std::make_shared<BooleanObject>(left_val < right_val);
-        if (node->op == "==")
-            return std::make_shared<BooleanObject>(left_val == right_val);
-        if (node->op == "!=")
-            return std::make_shared<BooleanObject>(left_val != right_val);
-    }
-    return nullptr;
-}
-
-std::shared_ptr<Object> Interpreter::evalPrefixExpression(PrefixExpressionNode *node,
-                                                          std::shared_ptr<Environment> env) {
-    auto right = eval(node->right.get(), env);
-    if (!right)
-        return nullptr;
-    if (node->op == "-") {
-        if (right->type != ObjectType::INTEGER)
-            return nullptr;
-        auto val = std::dynamic_pointer_cast<IntegerObject>(right)->value;
-        return std::make_shared<IntegerObject>(-val);
-    }
-    return nullptr;
+    if (typed_ && node->static_type != StaticType::DYNAMIC)
+        return evalIntegerInfix(node, locals);
+
+    // `left` is not rooted while `right` runs; only integer operands are
+    // ever looked at, and those are not heap objects.
+    auto left = eval(node->left, locals);
+    auto right = eval(node->right, locals);
+
+    if (left.isInteger() && right.isInteger()) {
+        auto left_val = left.asInteger();
+        auto right_val = right.asInteger();
+
+        switch (node->op) {
+        case Operator::ADD:
+            return Value::Integer(Wrap(static_cast<uint32_t>(left_val) + static_cast<uint32_t>(right_val)));
+        case Operator::SUBTRACT:
+            return Value::Integer(Wrap(static_cast<uint32_t>(left_val) - static_cast<uint32_t>(right_val)));
+        case Operator::MULTIPLY:
+            return Value::Integer(Wrap(static_cast<uint32_t>(left_val) * static_cast<uint32_t>(right_val)));
+        case Operator::DIVIDE:
+            return Value::Integer(Divide(left_val, right_val));
+        case Operator::GREATER:
+            return Value::Boolean(left_val > right_val);
+        case Operator::LESS:
+            return Value::Boolean(left_val < right_val);
+        case Operator::EQUAL:
+            return Value::Boolean(left_val == right_val);
+        case Operator::NOT_EQUAL:
+            return Value::Boolean(left_val != right_val);
+        case Operator::ASSIGN:
+            // Assignment to something other than a name.
+            break;
+        }
+    }
+    return Value();
+}
+
+int32_t Interpreter::evalInteger(const ExpressionNode *node, Value *locals) {
+    // Variables and literals, the usual operands, skip the dispatch. Only
+    // plain locals are ever typed.
+    if (auto id = NodeCast<IdentifierNode>(node))
+        return locals[id->slot].asInteger();
+    if (auto nl = NodeCast<NumberLiteralNode>(node))
+        return nl->value;
+    return eval(node, locals).asInteger();
+}
+
+Value Interpreter::evalIntegerInfix(const InfixExpressionNode *node, Value *locals) {
+    int32_t left = evalInteger(node->left, locals);
+    int32_t right = evalInteger(node->right, locals);
+    switch (node->op) {
+    case Operator::ADD:
+        return Value::Integer(Wrap(static_cast<uint32_t>(left) + static_cast<uint32_t>(right)));
+    case Operator::SUBTRACT:
+        return Value::Integer(Wrap(static_cast<uint32_t>(left) - static_cast<uint32_t>(right)));
+    case Operator::MULTIPLY:
+        return Value::Integer(Wrap(static_cast<uint32_t>(left) * static_cast<uint32_t>(right)));
+    case Operator::DIVIDE:
+        return Value::Integer(Divide(left, right));
+    case Operator::GREATER:
+        return Value::Boolean(left > right);
+    case Operator::LESS:
+        return Value::Boolean(left < right);
+    case Operator::EQUAL:
+        return Value::Boolean(left == right);
+    case Operator::NOT_EQUAL:
+        return Value::Boolean(left != right);
+    case Operator::ASSIGN:
+        break;
+    }
+    return Value();
+}
+
+Value Interpreter::evalPrefixExpression(const PrefixExpressionNode *node, Value *locals) {
+    if (typed_ && node->static_type == StaticType::INT32)
+        return Value::Integer(Wrap(0u - static_cast<uint32_t>(evalInteger(node->right, locals))));
+
+    auto right = eval(node->right, locals);
+    if (node->op == Operator::SUBTRACT && right.isInteger()) {
+        return Value::Integer(Wrap(0u - static_cast<uint32_t>(right.asInteger())));
+    }
+    return Value();
 }
 
 } // namespace suplang
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "Interpreter/LazyFunctions.h"
+
+#include "Interpreter/Resolver.h"
+#include "Interpreter/TypeChecker.h"
+#include "Lexer/Lexer.h"
+#include "Optimizer/ConstantFolder.h"
+#include "Parser/Parser.h"
+
+namespace suplang {
+
+bool LazyFunctions::load(const FunctionLiteralNode *function) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Another thread may have loaded it while this one waited.
+    if (!function->isDeferred())
+        return true;
+    if (failed_.count(function))
+        return false;
+
+    // Deferred nodes are only ever reached through the const tree that
+    // interpreters run, but belong to `tree_`, which this may change.
+    auto node = const_cast<FunctionLiteralNode *>(function);
+    Lexer lexer(source_);
+    lexer.resumeAt(node->body_offset, node->body_location);
+    Parser parser(lexer);
+    node->body = parser.parseFunctionBody(tree_.arena());
+
+    ConstantFolder(tree_.arena()).foldFunction(node);
+    Resolver(tree_.arena()).resolveFunction(node, globals_);
+    if (parser.errorCount() > 0 || !TypeChecker().checkFunction(node)) {
+        failed_.insert(function);
+        return false;
+    }
+    // Publishes the body and its annotations to the threads that see the
+    // flag cleared.
+    node->deferred.store(false, std::memory_order_release);
+    return true;
+}
+
+} // namespace suplang
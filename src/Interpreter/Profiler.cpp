@@ -0,0 +1,193 @@
+#include "Interpreter/Profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <unordered_map>
+
+namespace suplang {
+
+namespace {
+
+// A function's name and the line it is defined on, or the program's label.
+std::string FunctionLabel(const FunctionLiteralNode *function) {
+    if (!function)
+        return "<program>";
+    std::string name = function->name == kNoSymbol ? "<anonymous>" : std::string(SymbolName(function->name));
+    return name + ":" + std::to_string(function->location.line);
+}
+
+double Millis(uint64_t nanoseconds) { return nanoseconds / 1e6; }
+
+} // namespace
+
+Profiler::Profiler() {
+    paths_.push_back({nullptr, 0, {}, {}, {}});
+    paths_[0].own.count = 1;
+    calls_.push_back(0);
+    current_ = &paths_[0].own;
+    last_ = Clock::now();
+}
+
+void Profiler::enterFunction(const FunctionLiteralNode *function) {
+    charge();
+    size_t parent = calls_.back();
+    size_t path = paths_.size();
+    for (const auto &[child_function, child] : paths_[parent].children) {
+        if (child_function == function) {
+            path = child;
+            break;
+        }
+    }
+    if (path == paths_.size()) {
+        paths_[parent].children.push_back({function, path});
+        paths_.push_back({function, parent, {}, {}, {}});
+    }
+    calls_.push_back(path);
+    saved_.push_back(current_);
+    current_ = &paths_[path].own;
+    ++current_->count;
+}
+
+void Profiler::leaveFunction() {
+    charge();
+    calls_.pop_back();
+    current_ = saved_.back();
+    saved_.pop_back();
+}
+
+void Profiler::enterStatement(const StatementNode *statement) {
+    charge();
+    saved_.push_back(current_);
+    current_ = &paths_[calls_.back()].statements[statement];
+    ++current_->count;
+}
+
+void Profiler::leaveStatement() {
+    charge();
+    current_ = saved_.back();
+    saved_.pop_back();
+}
+
+void Profiler::writeCollapsed(std::ostream &out) const {
+    // Walks the paths depth first, with the frames of the current one in
+    // `stack`. Each entry of `walk` is a path and the length of its caller's
+    // frames, which every path visited in between extends.
+    std::string stack;
+    std::vector<std::pair<size_t, size_t>> walk = {{0, 0}};
+    while (!walk.empty()) {
+        auto [index, length] = walk.back();
+        walk.pop_back();
+        const Path &path = paths_[index];
+        stack.resize(length);
+        stack += (length ? ";" : "") + FunctionLabel(path.function);
+        if (path.own.nanoseconds)
+            out << stack << " " << path.own.nanoseconds << "\n";
+
+        // Statements on the same line are one frame.
+        std::vector<std::pair<uint32_t, uint64_t>> lines;
+        for (const auto &[statement, time] : path.statements) {
+            if (time.nanoseconds)
+                lines.push_back({statement->location.line, time.nanoseconds});
+        }
+        std::sort(lines.begin(), lines.end());
+        for (size_t i = 0; i < lines.size(); ++i) {
+            uint64_t nanoseconds = lines[i].second;
+            while (i + 1 < lines.size() && lines[i + 1].first == lines[i].first) {
+                nanoseconds += lines[++i].second;
+            }
+            out << stack << ";line " << lines[i].first << " " << nanoseconds << "\n";
+        }
+
+        for (auto child = path.children.rbegin(); child != path.children.rend(); ++child) {
+            walk.push_back({child->second, stack.size()});
+        }
+    }
+}
+
+void Profiler::writeReport(std::ostream &out, size_t limit) const {
+    // The time under each path, its own and its callees'.
+    std::vector<uint64_t> totals(paths_.size());
+    for (size_t i = paths_.size(); i-- > 0;) {
+        const Path &path = paths_[i];
+        totals[i] += path.own.nanoseconds;
+        for (const auto &entry : path.statements) {
+            totals[i] += entry.second.nanoseconds;
+        }
+        if (i > 0)
+            totals[path.parent] += totals[i];
+    }
+
+    struct FunctionRow {
+        const FunctionLiteralNode *function = nullptr;
+        uint64_t calls = 0;
+        uint64_t total = 0;
+        uint64_t self = 0;
+    };
+    struct StatementRow {
+        const StatementNode *statement = nullptr;
+        const FunctionLiteralNode *function = nullptr;
+        Time time;
+    };
+    std::unordered_map<const FunctionLiteralNode *, FunctionRow> functions;
+    std::unordered_map<const StatementNode *, StatementRow> statements;
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        const Path &path = paths_[i];
+        FunctionRow &row = functions[path.function];
+        row.function = path.function;
+        row.calls += path.own.count;
+        row.self += path.own.nanoseconds;
+        for (const auto &[statement, time] : path.statements) {
+            row.self += time.nanoseconds;
+            StatementRow &statement_row = statements[statement];
+            statement_row.statement = statement;
+            statement_row.function = path.function;
+            statement_row.time.nanoseconds += time.nanoseconds;
+            statement_row.time.count += time.count;
+        }
+        // A recursive call's time is already in the outermost call's.
+        bool nested = false;
+        for (size_t p = i; p > 0 && !nested;) {
+            p = paths_[p].parent;
+            nested = paths_[p].function == path.function;
+        }
+        if (!nested)
+            row.total += totals[i];
+    }
+
+    std::vector<FunctionRow> function_rows;
+    for (const auto &entry : functions) {
+        function_rows.push_back(entry.second);
+    }
+    std::sort(function_rows.begin(), function_rows.end(),
+              [](const FunctionRow &a, const FunctionRow &b) { return a.total > b.total; });
+    std::vector<StatementRow> statement_rows;
+    for (const auto &entry : statements) {
+        statement_rows.push_back(entry.second);
+    }
+    std::sort(statement_rows.begin(), statement_rows.end(),
+              [](const StatementRow &a, const StatementRow &b) { return a.time.nanoseconds > b.time.nanoseconds; });
+
+    out << std::left << std::setw(32) << "function" << std::right << std::setw(12) << "calls" << std::setw(12)
+        << "total ms" << std::setw(12) << "self ms\n";
+    for (size_t i = 0; i < function_rows.size() && i < limit; ++i) {
+        const FunctionRow &row = function_rows[i];
+        out << std::left << std::setw(32) << FunctionLabel(row.function) << std::right << std::setw(12) << row.calls
+            << std::fixed << std::setprecision(3) << std::setw(12) << Millis(row.total) << std::setw(12)
+            << Millis(row.self) << "\n";
+    }
+
+    out << "\n"
+        << std::left << std::setw(32) << "statement" << std::right << std::setw(12) << "count" << std::setw(12)
+        << "self ms\n";
+    for (size_t i = 0; i < statement_rows.size() && i < limit; ++i) {
+        const StatementRow &row = statement_rows[i];
+        SourceLocation location = row.statement->location;
+        std::string label = std::to_string(location.line) + ":" + std::to_string(location.column) + " in " +
+                            FunctionLabel(row.function);
+        out << std::left << std::setw(32) << label << std::right << std::setw(12) << row.time.count << std::setw(12)
+            << Millis(row.time.nanoseconds) << "\n";
+    }
+}
+
+} // namespace suplang
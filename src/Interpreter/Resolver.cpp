@@ -0,0 +1,158 @@
+#include "Interpreter/Resolver.h"
+
+#include "VM/Locals.h"
+
+namespace suplang {
+
+std::vector<Symbol> Resolver::resolve(ProgramNode *program) {
+    std::vector<Symbol> names;
+    for (const auto &stmt : program->statements) {
+        CollectLocals(stmt, &names);
+    }
+
+    beginScope(names, nullptr);
+    program->num_locals = names.size();
+    for (const auto &stmt : program->statements) {
+        resolveNode(stmt);
+    }
+    endScope();
+    return names;
+}
+
+void Resolver::resolveNode(ASTNode *node) {
+    if (!node)
+        return;
+
+    if (auto bs = NodeCast<BlockStatementNode>(node)) {
+        for (const auto &stmt : bs->statements)
+            resolveNode(stmt);
+    } else if (auto es = NodeCast<ExpressionStatementNode>(node)) {
+        resolveNode(es->expression);
+    } else if (auto vd = NodeCast<VarDeclNode>(node)) {
+        resolveNode(vd->initialValue);
+        vd->slot = scopes_.back().slots.at(vd->varName);
+        vd->captured = false;
+        scopes_.back().declarations.push_back(vd);
+    } else if (auto rs = NodeCast<ReturnStatementNode>(node)) {
+        resolveNode(rs->return_value);
+    } else if (auto is = NodeCast<IfStatementNode>(node)) {
+        resolveNode(is->condition);
+        resolveNode(is->consequence);
+        resolveNode(is->alternative);
+    } else if (auto ws = NodeCast<WhileStatementNode>(node)) {
+        resolveNode(ws->condition);
+        resolveNode(ws->body);
+    } else if (auto ie = NodeCast<InfixExpressionNode>(node)) {
+        resolveNode(ie->left);
+        resolveNode(ie->right);
+    } else if (auto pe = NodeCast<PrefixExpressionNode>(node)) {
+        resolveNode(pe->right);
+    } else if (auto id = NodeCast<IdentifierNode>(node)) {
+        resolveIdentifier(id);
+    } else if (auto fl = NodeCast<FunctionLiteralNode>(node)) {
+        // A deferred body is resolved once parsed (see resolveFunction).
+        if (!fl->isDeferred())
+            resolveFunctionLiteral(fl);
+    } else if (auto ce = NodeCast<CallExpressionNode>(node)) {
+        resolveNode(ce->function);
+        for (const auto &arg : ce->arguments)
+            resolveNode(arg);
+    }
+}
+
+void Resolver::resolveFunction(FunctionLiteralNode *function, const std::vector<Symbol> &globals) {
+    beginScope(globals, nullptr);
+    resolveFunctionLiteral(function);
+    endScope();
+}
+
+void Resolver::resolveFunctionLiteral(FunctionLiteralNode *node) {
+    std::vector<Symbol> names;
+    for (const auto &param : node->parameters) {
+        names.push_back(param.param_name);
+    }
+    CollectLocals(node->body, &names);
+
+    beginScope(names, node);
+    node->num_locals = names.size();
+    resolveNode(node->body);
+    endScope();
+}
+
+void Resolver::resolveIdentifier(IdentifierNode *node) {
+    size_t level = scopes_.size() - 1;
+    for (size_t owner = level + 1; owner-- > 0;) {
+        auto it = scopes_[owner].slots.find(node->symbol);
+        if (it == scopes_[owner].slots.end())
+            continue;
+        if (owner == level) {
+            node->variable = VariableKind::LOCAL;
+            node->slot = it->second;
+            scopes_[level].local_uses.push_back(node);
+        } else if (owner == 0) {
+            node->variable = VariableKind::GLOBAL;
+            node->slot = it->second;
+        } else {
+            node->variable = VariableKind::UPVALUE;
+            node->slot = upvalue(level, owner, it->second);
+        }
+        return;
+    }
+    node->variable = VariableKind::UNBOUND;
+}
+
+size_t Resolver::upvalue(size_t level, size_t owner, size_t slot) {
+    UpvalueRef ref;
+    if (level - 1 == owner) {
+        scopes_[owner].captured[slot] = true;
+        ref = {true, slot};
+    } else {
+        ref = {false, upvalue(level - 1, owner, slot)};
+    }
+
+    auto &upvalues = scopes_[level].upvalues;
+    for (size_t i = 0; i < upvalues.size(); ++i) {
+        if (upvalues[i].from_local == ref.from_local && upvalues[i].index == ref.index)
+            return i;
+    }
+    upvalues.push_back(ref);
+    return upvalues.size() - 1;
+}
+
+void Resolver::beginScope(const std::vector<Symbol> &names, FunctionLiteralNode *function) {
+    Scope scope;
+    for (size_t slot = 0; slot < names.size(); ++slot) {
+        // Every parameter keeps its own slot; a repeated one resolves to the
+        // last occurrence, which is the one bound last at call time.
+        scope.slots[names[slot]] = slot;
+    }
+    scope.function = function;
+    scope.captured.assign(names.size(), false);
+    scopes_.push_back(std::move(scope));
+}
+
+void Resolver::endScope() {
+    Scope &scope = scopes_.back();
+    if (scope.function) {
+        std::vector<size_t> captured_slots;
+        for (size_t slot = 0; slot < scope.captured.size(); ++slot) {
+            if (scope.captured[slot])
+                captured_slots.push_back(slot);
+        }
+        scope.function->captured_slots = arena_.copyArray(captured_slots);
+        scope.function->upvalues = arena_.copyArray(scope.upvalues);
+
+        // The function's own reads and writes of a captured variable go
+        // through its cell too.
+        for (IdentifierNode *id : scope.local_uses) {
+            if (scope.captured[id->slot])
+                id->variable = VariableKind::CELL;
+        }
+        for (VarDeclNode *vd : scope.declarations) {
+            vd->captured = scope.captured[vd->slot];
+        }
+    }
+    scopes_.pop_back();
+}
+
+} // namespace suplang
@@ -0,0 +1,249 @@
+#include "Interpreter/TypeChecker.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace suplang {
+
+namespace {
+// The declared types the checker enforces; the others are not checked.
+StaticType DeclaredType(std::string_view type_name) {
+    if (type_name == "int32")
+        return StaticType::INT32;
+    if (type_name == "bool")
+        return StaticType::BOOL;
+    return StaticType::DYNAMIC;
+}
+
+bool IsComparison(Operator op) {
+    return op == Operator::LESS || op == Operator::GREATER || op == Operator::EQUAL || op == Operator::NOT_EQUAL;
+}
+} // namespace
+
+bool TypeChecker::check(ProgramNode *program) {
+    ok_ = true;
+    checkScope(program->statements, program->num_locals, nullptr);
+    return ok_;
+}
+
+bool TypeChecker::checkFunction(FunctionLiteralNode *function) {
+    ok_ = true;
+    checkFunctionLiteral(function);
+    return ok_;
+}
+
+void TypeChecker::checkScope(const ArenaArray<StatementNode *> &statements, size_t num_slots,
+                             const ArenaArray<Parameter> *parameters) {
+    slots_.assign(num_slots, Slot());
+    size_t arity = parameters ? parameters->size() : 0;
+    for (size_t i = 0; i < arity; ++i) {
+        slots_[i].declared = (*parameters)[i].static_type;
+    }
+    for (const auto &stmt : statements) {
+        declare(stmt);
+    }
+
+    final_pass_ = false;
+    do {
+        changed_ = false;
+        // Parameters are bound on entry.
+        defined_.assign(num_slots, false);
+        std::fill(defined_.begin(), defined_.begin() + arity, true);
+        for (const auto &stmt : statements) {
+            statement(stmt);
+        }
+    } while (changed_);
+
+    final_pass_ = true;
+    defined_.assign(num_slots, false);
+    std::fill(defined_.begin(), defined_.begin() + arity, true);
+    for (const auto &stmt : statements) {
+        statement(stmt);
+    }
+}
+
+void TypeChecker::checkFunctionLiteral(FunctionLiteralNode *node) {
+    for (auto &param : node->parameters) {
+        param.static_type = DeclaredType(param.type_name);
+    }
+
+    // The function is a scope of its own; the enclosing one resumes after.
+    std::vector<Slot> slots = std::move(slots_);
+    std::vector<bool> defined = std::move(defined_);
+    ArenaArray<StatementNode *> statements = node->body ? node->body->statements : ArenaArray<StatementNode *>();
+    checkScope(statements, node->num_locals, &node->parameters);
+    slots_ = std::move(slots);
+    defined_ = std::move(defined);
+}
+
+void TypeChecker::declare(StatementNode *node) {
+    if (auto bs = NodeCast<BlockStatementNode>(node)) {
+        for (const auto &stmt : bs->statements)
+            declare(stmt);
+    } else if (auto is = NodeCast<IfStatementNode>(node)) {
+        declare(is->consequence);
+        if (is->alternative)
+            declare(is->alternative);
+    } else if (auto ws = NodeCast<WhileStatementNode>(node)) {
+        declare(ws->body);
+    } else if (auto vd = NodeCast<VarDeclNode>(node)) {
+        StaticType type = DeclaredType(vd->varType);
+        Slot &slot = slots_[vd->slot];
+        if (type == StaticType::DYNAMIC)
+            return;
+        if (slot.declared != StaticType::DYNAMIC && slot.declared != type) {
+            error(vd) << "'" << SymbolName(vd->varName) << "' is declared both " << StaticTypeName(slot.declared)
+                    << " and " << StaticTypeName(type) << ".\n";
+            slot.trusted = false;
+            return;
+        }
+        slot.declared = type;
+    }
+}
+
+StaticType TypeChecker::expression(ExpressionNode *node) {
+    if (!node)
+        return StaticType::DYNAMIC;
+
+    StaticType type = StaticType::DYNAMIC;
+    if (NodeCast<NumberLiteralNode>(node)) {
+        type = StaticType::INT32;
+    } else if (NodeCast<BooleanLiteralNode>(node)) {
+        type = StaticType::BOOL;
+    } else if (auto id = NodeCast<IdentifierNode>(node)) {
+        if (id->variable == VariableKind::LOCAL && slots_[id->slot].trusted && defined_[id->slot])
+            type = slots_[id->slot].declared;
+    } else if (auto pe = NodeCast<PrefixExpressionNode>(node)) {
+        type = operatorType(pe, pe->op, StaticType::INT32, expression(pe->right));
+    } else if (auto ie = NodeCast<InfixExpressionNode>(node)) {
+        if (ie->op == Operator::ASSIGN) {
+            StaticType value = expression(ie->right);
+            if (auto id = NodeCast<IdentifierNode>(ie->left)) {
+                // Assignment targets are always bound in the current scope.
+                StaticType declared = slots_[id->slot].declared;
+                if (final_pass_ && value != StaticType::DYNAMIC && declared != StaticType::DYNAMIC &&
+                    value != declared) {
+                    error(ie) << "cannot assign a " << StaticTypeName(value) << " value to " << StaticTypeName(declared)
+                            << " variable '" << SymbolName(id->symbol) << "'.\n";
+                }
+                store(id->slot, value);
+                type = value;
+            } else {
+                // Assignment to something other than a name gives null.
+                expression(ie->left);
+            }
+        } else {
+            StaticType left = expression(ie->left);
+            type = operatorType(ie, ie->op, left, expression(ie->right));
+        }
+    } else if (auto fl = NodeCast<FunctionLiteralNode>(node)) {
+        // Nested functions are checked once, in the final pass. Deferred
+        // bodies are checked once parsed.
+        if (final_pass_ && !fl->isDeferred())
+            checkFunctionLiteral(fl);
+        type = StaticType::FUNCTION;
+    } else if (auto ce = NodeCast<CallExpressionNode>(node)) {
+        StaticType callee = expression(ce->function);
+        if (final_pass_ && (callee == StaticType::INT32 || callee == StaticType::BOOL))
+            error(ce) << "cannot call a value of type " << StaticTypeName(callee) << ".\n";
+        for (const auto &arg : ce->arguments)
+            expression(arg);
+    }
+
+    if (final_pass_)
+        node->static_type = type;
+    return type;
+}
+
+StaticType TypeChecker::operatorType(const ExpressionNode *node, Operator op, StaticType left, StaticType right) {
+    // Operators give null on anything but two int32 operands.
+    for (StaticType operand : {left, right}) {
+        if (operand != StaticType::DYNAMIC && operand != StaticType::INT32) {
+            if (final_pass_)
+                error(node) << "operator '" << OperatorSpelling(op) << "' needs int32 operands, got "
+                        << StaticTypeName(operand) << ".\n";
+            return StaticType::DYNAMIC;
+        }
+    }
+    if (left != StaticType::INT32 || right != StaticType::INT32)
+        return StaticType::DYNAMIC;
+    return IsComparison(op) ? StaticType::BOOL : StaticType::INT32;
+}
+
+bool TypeChecker::statement(StatementNode *node) {
+    if (auto bs = NodeCast<BlockStatementNode>(node)) {
+        // Statements after one that never completes are still checked.
+        bool completes = true;
+        for (const auto &stmt : bs->statements) {
+            if (!statement(stmt))
+                completes = false;
+        }
+        return completes;
+    }
+    if (auto es = NodeCast<ExpressionStatementNode>(node)) {
+        expression(es->expression);
+        return true;
+    }
+    if (auto vd = NodeCast<VarDeclNode>(node)) {
+        if (!vd->initialValue)
+            return true;
+        StaticType value = expression(vd->initialValue);
+        StaticType declared = DeclaredType(vd->varType);
+        if (final_pass_ && value != StaticType::DYNAMIC && declared != StaticType::DYNAMIC && value != declared) {
+            error(vd) << "cannot initialize " << StaticTypeName(declared) << " variable '" << SymbolName(vd->varName)
+                    << "' with a " << StaticTypeName(value) << " value.\n";
+        }
+        store(vd->slot, value);
+        return true;
+    }
+    if (auto rs = NodeCast<ReturnStatementNode>(node)) {
+        expression(rs->return_value);
+        return false;
+    }
+    if (auto is = NodeCast<IfStatementNode>(node)) {
+        expression(is->condition);
+        std::vector<bool> before = defined_;
+        bool consequence = statement(is->consequence);
+        std::vector<bool> after_consequence = std::move(defined_);
+        defined_ = std::move(before);
+        bool alternative = is->alternative ? statement(is->alternative) : true;
+        // A slot is certainly assigned after the statement if it is after
+        // every branch that completes.
+        if (!alternative) {
+            defined_ = std::move(after_consequence);
+        } else if (consequence) {
+            for (size_t i = 0; i < defined_.size(); ++i) {
+                defined_[i] = defined_[i] && after_consequence[i];
+            }
+        }
+        return consequence || alternative;
+    }
+    if (auto ws = NodeCast<WhileStatementNode>(node)) {
+        expression(ws->condition);
+        // The body may not run at all.
+        std::vector<bool> before = defined_;
+        statement(ws->body);
+        defined_ = std::move(before);
+        // `while (true)` only ends through a return.
+        auto literal = NodeCast<BooleanLiteralNode>(ws->condition);
+        return !(literal && literal->value);
+    }
+    return true;
+}
+
+void TypeChecker::store(size_t slot, StaticType type) {
+    Slot &target = slots_[slot];
+    if (type != target.declared && target.trusted) {
+        target.trusted = false;
+        changed_ = true;
+    }
+    defined_[slot] = true;
+}
+
+std::ostream &TypeChecker::error(const ASTNode *node) {
+    ok_ = false;
+    return std::cerr << "Type error at " << node->location.line << ":" << node->location.column << ": ";
+}
+
+} // namespace suplang
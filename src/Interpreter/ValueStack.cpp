@@ -0,0 +1,26 @@
+#include "Interpreter/ValueStack.h"
+
+#include <algorithm>
+
+namespace suplang {
+
+Value *ValueStack::pushChunk(size_t size) {
+    // The first chunk starts out empty, so that idle interpreters cost
+    // nothing.
+    if (chunks_[current_].used > 0)
+        ++current_;
+    if (current_ == chunks_.size())
+        chunks_.emplace_back();
+
+    Chunk &chunk = chunks_[current_];
+    if (chunk.size < size) {
+        chunk.size = std::max(kChunkSize, size);
+        chunk.values = std::make_unique<Value[]>(chunk.size);
+    } else {
+        std::fill(chunk.values.get(), chunk.values.get() + size, Value());
+    }
+    chunk.used = size;
+    return chunk.values.get();
+}
+
+} // namespace suplang
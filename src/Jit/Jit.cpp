@@ -0,0 +1,550 @@
+#include "Jit/Jit.h"
+
+#include "AST/NodeVisitor.h"
+#include "Jit/X64Assembler.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define SUPLANG_JIT_SUPPORTED 1
+#endif
+
+namespace suplang {
+
+namespace {
+
+bool IsComparison(Operator op) {
+    return op == Operator::LESS || op == Operator::GREATER || op == Operator::EQUAL || op == Operator::NOT_EQUAL;
+}
+
+X64Condition ConditionOf(Operator op) {
+    switch (op) {
+    case Operator::LESS:
+        return X64Condition::LESS;
+    case Operator::GREATER:
+        return X64Condition::GREATER;
+    case Operator::EQUAL:
+        return X64Condition::EQUAL;
+    default:
+        return X64Condition::NOT_EQUAL;
+    }
+}
+
+// `while (true)` only ends through a return.
+bool Diverges(const WhileStatementNode *node) {
+    auto literal = NodeCast<BooleanLiteralNode>(node->condition);
+    return literal && literal->value;
+}
+
+// Decides whether a function fits the JIT and gives each of its slots a type.
+// The body is walked once in program order, tracking the slots certainly
+// assigned at each point; as a slot must be assigned before it is read, its
+// type is always known where it is read.
+//
+// A statement in tail position must produce the function's result when it
+// completes, as the last statement of a body does.
+class SubsetChecker {
+  public:
+    explicit SubsetChecker(size_t num_locals) : slots_(num_locals), defined_(num_locals) {}
+
+    bool check(const ArenaArray<Parameter> &parameters, const BlockStatementNode *body) {
+        if (parameters.size() > JitCompiler::kMaxParameters || parameters.size() > slots_.size())
+            return false;
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            if (parameters[i].type_name == "int32") {
+                define(i, JitType::INTEGER);
+            } else if (parameters[i].type_name == "bool") {
+                define(i, JitType::BOOLEAN);
+            } else {
+                return false;
+            }
+        }
+        statement(body, true);
+        return ok_ && result_ != JitType::UNKNOWN;
+    }
+
+    const std::vector<JitType> &slots() const { return slots_; }
+    JitType result() const { return result_; }
+
+  private:
+    JitType expression(const ExpressionNode *node) {
+        if (!ok_ || !node)
+            return fail();
+        switch (node->kind) {
+        case NodeKind::NUMBER_LITERAL:
+            return JitType::INTEGER;
+        case NodeKind::BOOLEAN_LITERAL:
+            return JitType::BOOLEAN;
+        case NodeKind::IDENTIFIER: {
+            auto id = static_cast<const IdentifierNode *>(node);
+            if (id->variable != VariableKind::LOCAL || id->slot >= slots_.size() || !defined_[id->slot])
+                return fail();
+            return slots_[id->slot];
+        }
+        case NodeKind::PREFIX_EXPRESSION: {
+            auto pe = static_cast<const PrefixExpressionNode *>(node);
+            if (pe->op != Operator::SUBTRACT || expression(pe->right) != JitType::INTEGER)
+                return fail();
+            return JitType::INTEGER;
+        }
+        case NodeKind::INFIX_EXPRESSION: {
+            auto ie = static_cast<const InfixExpressionNode *>(node);
+            if (ie->op == Operator::ASSIGN) {
+                auto id = NodeCast<IdentifierNode>(ie->left);
+                if (!id || id->variable != VariableKind::LOCAL)
+                    return fail();
+                JitType type = expression(ie->right);
+                define(id->slot, type);
+                return type;
+            }
+            // Operators on anything but two integers give null.
+            if (expression(ie->left) != JitType::INTEGER || expression(ie->right) != JitType::INTEGER)
+                return fail();
+            return IsComparison(ie->op) ? JitType::BOOLEAN : JitType::INTEGER;
+        }
+        default:
+            // Calls, function literals and anything else.
+            return fail();
+        }
+    }
+
+    // Returns whether control can reach the end of `node`.
+    bool statement(const StatementNode *node, bool tail) {
+        if (!ok_)
+            return false;
+        switch (node->kind) {
+        case NodeKind::EXPRESSION_STATEMENT: {
+            JitType type = expression(static_cast<const ExpressionStatementNode *>(node)->expression);
+            if (tail)
+                produce(type);
+            return true;
+        }
+        case NodeKind::VAR_DECL: {
+            auto vd = static_cast<const VarDeclNode *>(node);
+            if (!vd->initialValue) {
+                // Declares nothing and produces null.
+                if (tail)
+                    fail();
+                return true;
+            }
+            JitType type = expression(vd->initialValue);
+            define(vd->slot, type);
+            if (tail)
+                produce(type);
+            return true;
+        }
+        case NodeKind::RETURN_STATEMENT:
+            produce(expression(static_cast<const ReturnStatementNode *>(node)->return_value));
+            return false;
+        case NodeKind::BLOCK_STATEMENT: {
+            const auto &statements = static_cast<const BlockStatementNode *>(node)->statements;
+            if (statements.empty() && tail)
+                fail();
+            for (size_t i = 0; i < statements.size(); ++i) {
+                // Whatever follows a statement that never completes is dead.
+                if (!statement(statements[i], tail && i + 1 == statements.size()))
+                    return false;
+            }
+            return true;
+        }
+        case NodeKind::IF_STATEMENT: {
+            auto is = static_cast<const IfStatementNode *>(node);
+            condition(is->condition);
+            std::vector<bool> before = defined_;
+            bool consequence = statement(is->consequence, tail);
+            std::vector<bool> after_consequence = std::move(defined_);
+            defined_ = std::move(before);
+            bool alternative = true;
+            if (is->alternative) {
+                alternative = statement(is->alternative, tail);
+            } else if (tail) {
+                fail();
+            }
+            // A slot is certainly assigned after the statement if it is after
+            // every branch that completes.
+            if (!alternative) {
+                defined_ = std::move(after_consequence);
+            } else if (consequence) {
+                for (size_t i = 0; i < defined_.size(); ++i) {
+                    defined_[i] = defined_[i] && after_consequence[i];
+                }
+            }
+            return consequence || alternative;
+        }
+        case NodeKind::WHILE_STATEMENT: {
+            auto ws = static_cast<const WhileStatementNode *>(node);
+            condition(ws->condition);
+            // The body may not run at all.
+            std::vector<bool> before = defined_;
+            statement(ws->body, false);
+            defined_ = std::move(before);
+            if (Diverges(ws))
+                return false;
+            if (tail)
+                fail();
+            return true;
+        }
+        default:
+            fail();
+            return false;
+        }
+    }
+
+    void condition(const ExpressionNode *node) {
+        // Both types work as conditions; integers are always true.
+        expression(node);
+    }
+
+    void define(size_t slot, JitType type) {
+        if (!ok_ || type == JitType::UNKNOWN)
+            return;
+        if (slots_[slot] != JitType::UNKNOWN && slots_[slot] != type) {
+            fail();
+            return;
+        }
+        slots_[slot] = type;
+        defined_[slot] = true;
+    }
+
+    void produce(JitType type) {
+        if (!ok_ || type == JitType::UNKNOWN || (result_ != JitType::UNKNOWN && result_ != type)) {
+            fail();
+            return;
+        }
+        result_ = type;
+    }
+
+    JitType fail() {
+        ok_ = false;
+        return JitType::UNKNOWN;
+    }
+
+    std::vector<JitType> slots_;
+    std::vector<bool> defined_; // Slots certainly assigned at the current point.
+    JitType result_ = JitType::UNKNOWN;
+    bool ok_ = true;
+};
+
+// Generates the code of a function the SubsetChecker accepted, following the
+// same walk. The result is left in eax; slot `i` lives at rbp - 8 * (i + 1).
+class CodeGenerator {
+  public:
+    explicit CodeGenerator(const std::vector<JitType> &slots) : slots_(slots) {}
+
+    std::vector<uint8_t> generate(size_t arity, const BlockStatementNode *body) {
+        // Slots are 8 bytes apart and the frame stays 16-byte aligned.
+        auto frame_size = static_cast<int32_t>((slots_.size() * 8 + 15) & ~size_t{15});
+        masm_.prologue(frame_size);
+        for (size_t i = 0; i < arity; ++i) {
+            masm_.loadArgument(static_cast<int32_t>(i));
+            masm_.storeLocal(Offset(i));
+        }
+        statement(body, true);
+        masm_.bind(&exit_);
+        masm_.epilogue();
+        return masm_.code();
+    }
+
+  private:
+    struct Operand {
+        enum Kind { REGISTER, IMMEDIATE, LOCAL } kind;
+        int32_t value; // The immediate, or the local's frame offset.
+    };
+
+    static int32_t Offset(size_t slot) { return -8 * static_cast<int32_t>(slot + 1); }
+
+    JitType typeOf(const ExpressionNode *node) const {
+        switch (node->kind) {
+        case NodeKind::BOOLEAN_LITERAL:
+            return JitType::BOOLEAN;
+        case NodeKind::IDENTIFIER:
+            return slots_[static_cast<const IdentifierNode *>(node)->slot];
+        case NodeKind::INFIX_EXPRESSION: {
+            auto ie = static_cast<const InfixExpressionNode *>(node);
+            if (ie->op == Operator::ASSIGN)
+                return typeOf(ie->right);
+            return IsComparison(ie->op) ? JitType::BOOLEAN : JitType::INTEGER;
+        }
+        default:
+            return JitType::INTEGER;
+        }
+    }
+
+    void expression(const ExpressionNode *node) {
+        switch (node->kind) {
+        case NodeKind::NUMBER_LITERAL:
+            masm_.loadImmediate(static_cast<const NumberLiteralNode *>(node)->value);
+            break;
+        case NodeKind::BOOLEAN_LITERAL:
+            masm_.loadImmediate(static_cast<const BooleanLiteralNode *>(node)->value ? 1 : 0);
+            break;
+        case NodeKind::IDENTIFIER:
+            masm_.loadLocal(Offset(static_cast<const IdentifierNode *>(node)->slot));
+            break;
+        case NodeKind::PREFIX_EXPRESSION:
+            expression(static_cast<const PrefixExpressionNode *>(node)->right);
+            masm_.negate();
+            break;
+        case NodeKind::INFIX_EXPRESSION:
+            infix(static_cast<const InfixExpressionNode *>(node));
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Leaves the left operand in eax. A literal or variable right operand is
+    // used where it is; anything else is computed into ecx.
+    Operand operands(const InfixExpressionNode *node) {
+        expression(node->left);
+        if (auto nl = NodeCast<NumberLiteralNode>(node->right))
+            return {Operand::IMMEDIATE, nl->value};
+        if (auto id = NodeCast<IdentifierNode>(node->right))
+            return {Operand::LOCAL, Offset(id->slot)};
+        masm_.pushAccumulator();
+        expression(node->right);
+        masm_.popOperand();
+        return {Operand::REGISTER, 0};
+    }
+
+    // Emits the form of an instruction that takes `right`.
+    void emit(Operand right, void (X64Assembler::*immediate)(int32_t), void (X64Assembler::*local)(int32_t),
+              void (X64Assembler::*reg)()) {
+        if (right.kind == Operand::IMMEDIATE) {
+            (masm_.*immediate)(right.value);
+        } else if (right.kind == Operand::LOCAL) {
+            (masm_.*local)(right.value);
+        } else {
+            (masm_.*reg)();
+        }
+    }
+
+    void infix(const InfixExpressionNode *node) {
+        if (node->op == Operator::ASSIGN) {
+            expression(node->right);
+            masm_.storeLocal(Offset(static_cast<const IdentifierNode *>(node->left)->slot));
+            return;
+        }
+        if (IsComparison(node->op)) {
+            compare(node);
+            masm_.setCondition(ConditionOf(node->op));
+            return;
+        }
+
+        Operand right = operands(node);
+        switch (node->op) {
+        case Operator::ADD:
+            emit(right, &X64Assembler::addImmediate, &X64Assembler::addLocal, &X64Assembler::add);
+            break;
+        case Operator::SUBTRACT:
+            emit(right, &X64Assembler::subtractImmediate, &X64Assembler::subtractLocal, &X64Assembler::subtract);
+            break;
+        case Operator::MULTIPLY:
+            emit(right, &X64Assembler::multiplyImmediate, &X64Assembler::multiplyLocal, &X64Assembler::multiply);
+            break;
+        case Operator::DIVIDE: {
+            // idiv takes its divisor in a register. Division by zero traps,
+            // as it does in the interpreter, but so would INT32_MIN / -1, so
+            // dividing by -1 negates instead.
+            if (right.kind == Operand::IMMEDIATE) {
+                if (right.value == -1) {
+                    masm_.negate();
+                } else {
+                    masm_.loadOperandImmediate(right.value);
+                    masm_.divide();
+                }
+                break;
+            }
+            if (right.kind == Operand::LOCAL)
+                masm_.loadOperandLocal(right.value);
+            X64Label divide, done;
+            masm_.compareOperandImmediate(-1);
+            masm_.jumpIf(X64Condition::NOT_EQUAL, &divide);
+            masm_.negate();
+            masm_.jump(&done);
+            masm_.bind(&divide);
+            masm_.divide();
+            masm_.bind(&done);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    // Sets the flags from a comparison's operands.
+    void compare(const InfixExpressionNode *node) {
+        emit(operands(node), &X64Assembler::compareImmediate, &X64Assembler::compareLocal, &X64Assembler::compare);
+    }
+
+    // Jumps to `target` if the truthiness of `node` is `when`. Comparisons
+    // branch on the flags directly.
+    void branch(const ExpressionNode *node, bool when, X64Label *target) {
+        if (auto literal = NodeCast<BooleanLiteralNode>(node)) {
+            if (literal->value == when)
+                masm_.jump(target);
+            return;
+        }
+        auto ie = NodeCast<InfixExpressionNode>(node);
+        if (ie && IsComparison(ie->op)) {
+            compare(ie);
+            X64Condition condition = ConditionOf(ie->op);
+            masm_.jumpIf(when ? condition : Negate(condition), target);
+            return;
+        }
+        expression(node);
+        if (typeOf(node) == JitType::BOOLEAN) {
+            masm_.testAccumulator();
+            masm_.jumpIf(when ? X64Condition::NOT_EQUAL : X64Condition::EQUAL, target);
+        } else if (when) {
+            masm_.jump(target);
+        }
+    }
+
+    // Mirrors SubsetChecker::statement. A statement in tail position leaves the
+    // result in eax and leaves the function.
+    bool statement(const StatementNode *node, bool tail) {
+        switch (node->kind) {
+        case NodeKind::EXPRESSION_STATEMENT:
+            expression(static_cast<const ExpressionStatementNode *>(node)->expression);
+            if (tail)
+                masm_.jump(&exit_);
+            return true;
+        case NodeKind::VAR_DECL: {
+            auto vd = static_cast<const VarDeclNode *>(node);
+            if (vd->initialValue) {
+                expression(vd->initialValue);
+                masm_.storeLocal(Offset(vd->slot));
+                if (tail)
+                    masm_.jump(&exit_);
+            }
+            return true;
+        }
+        case NodeKind::RETURN_STATEMENT:
+            expression(static_cast<const ReturnStatementNode *>(node)->return_value);
+            masm_.jump(&exit_);
+            return false;
+        case NodeKind::BLOCK_STATEMENT: {
+            const auto &statements = static_cast<const BlockStatementNode *>(node)->statements;
+            for (size_t i = 0; i < statements.size(); ++i) {
+                if (!statement(statements[i], tail && i + 1 == statements.size()))
+                    return false;
+            }
+            return true;
+        }
+        case NodeKind::IF_STATEMENT: {
+            auto is = static_cast<const IfStatementNode *>(node);
+            X64Label otherwise, end;
+            branch(is->condition, false, &otherwise);
+            bool consequence = statement(is->consequence, tail);
+            if (!is->alternative) {
+                masm_.bind(&otherwise);
+                return true;
+            }
+            if (consequence)
+                masm_.jump(&end);
+            masm_.bind(&otherwise);
+            bool alternative = statement(is->alternative, tail);
+            masm_.bind(&end);
+            return consequence || alternative;
+        }
+        case NodeKind::WHILE_STATEMENT: {
+            // The condition is tested at the bottom, so each iteration takes
+            // a single branch.
+            auto ws = static_cast<const WhileStatementNode *>(node);
+            X64Label body, test;
+            if (Diverges(ws)) {
+                masm_.bind(&body);
+                statement(ws->body, false);
+                masm_.jump(&body);
+                return false;
+            }
+            masm_.jump(&test);
+            masm_.bind(&body);
+            statement(ws->body, false);
+            masm_.bind(&test);
+            branch(ws->condition, true, &body);
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    const std::vector<JitType> &slots_;
+    X64Assembler masm_;
+    X64Label exit_;
+};
+
+#if SUPLANG_JIT_SUPPORTED
+// Copies `code` into a fresh mapping and makes it executable, never writable
+// and executable at once. Returns null on failure.
+void *MapCode(const std::vector<uint8_t> &code, size_t *size) {
+    auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    *size = (code.size() + page - 1) / page * page;
+    void *memory = mmap(nullptr, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return nullptr;
+    std::memcpy(memory, code.data(), code.size());
+    if (mprotect(memory, *size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, *size);
+        return nullptr;
+    }
+    return memory;
+}
+#endif
+
+} // namespace
+
+JitFunction::~JitFunction() {
+#if SUPLANG_JIT_SUPPORTED
+    if (memory_)
+        munmap(memory_, size_);
+#endif
+}
+
+bool JitFunction::call(const Value *args, size_t argc, Value *result) const {
+    // Missing arguments would be null.
+    if (argc < parameters_.size())
+        return false;
+    int32_t raw[JitCompiler::kMaxParameters];
+    for (size_t i = 0; i < parameters_.size(); ++i) {
+        const Value &arg = args[i];
+        if (parameters_[i] == JitType::INTEGER ? !arg.isInteger() : !arg.isBoolean())
+            return false;
+        raw[i] = arg.isInteger() ? arg.asInteger() : arg.asBoolean();
+    }
+    int32_t value = entry_(raw);
+    *result = result_ == JitType::INTEGER ? Value::Integer(value) : Value::Boolean(value != 0);
+    return true;
+}
+
+std::unique_ptr<JitFunction> JitCompiler::compile(const ArenaArray<Parameter> &parameters,
+                                                  const BlockStatementNode *body, size_t num_locals) {
+#if SUPLANG_JIT_SUPPORTED
+    if (!body)
+        return nullptr;
+    SubsetChecker checker(num_locals);
+    if (!checker.check(parameters, body))
+        return nullptr;
+
+    std::vector<uint8_t> code = CodeGenerator(checker.slots()).generate(parameters.size(), body);
+    std::unique_ptr<JitFunction> function(new JitFunction());
+    function->memory_ = MapCode(code, &function->size_);
+    if (!function->memory_)
+        return nullptr;
+    function->entry_ = reinterpret_cast<JitFunction::Entry>(function->memory_);
+    function->parameters_.assign(checker.slots().begin(), checker.slots().begin() + parameters.size());
+    function->result_ = checker.result();
+    return function;
+#else
+    (void)parameters;
+    (void)body;
+    (void)num_locals;
+    return nullptr;
+#endif
+}
+
+} // namespace suplang
@@ -0,0 +1,177 @@
+#include "Jit/X64Assembler.h"
+
+namespace suplang {
+
+namespace {
+// Register numbers in ModRM fields.
+constexpr uint8_t kEax = 0;
+constexpr uint8_t kEcx = 1;
+} // namespace
+
+X64Condition Negate(X64Condition condition) {
+    // Conditions come in pairs that differ in the lowest bit.
+    return static_cast<X64Condition>(static_cast<uint8_t>(condition) ^ 1);
+}
+
+void X64Assembler::emit32(int32_t value) {
+    auto bits = static_cast<uint32_t>(value);
+    for (int i = 0; i < 4; ++i) {
+        emit(static_cast<uint8_t>(bits >> (8 * i)));
+    }
+}
+
+void X64Assembler::emitFrameOperand(uint8_t reg, int32_t offset) {
+    // mod = 10 (disp32), rm = 101 (rbp).
+    emit(static_cast<uint8_t>(0x80 | (reg << 3) | 0x5));
+    emit32(offset);
+}
+
+void X64Assembler::prologue(int32_t frame_size) {
+    emit(0x55);                         // push rbp
+    emit(0x48), emit(0x89), emit(0xE5); // mov rbp, rsp
+    emit(0x48), emit(0x81), emit(0xEC); // sub rsp, imm32
+    emit32(frame_size);
+}
+
+void X64Assembler::epilogue() {
+    emit(0xC9); // leave
+    emit(0xC3); // ret
+}
+
+void X64Assembler::loadImmediate(int32_t value) {
+    emit(0xB8 + kEax);
+    emit32(value);
+}
+
+void X64Assembler::loadLocal(int32_t offset) {
+    emit(0x8B);
+    emitFrameOperand(kEax, offset);
+}
+
+void X64Assembler::storeLocal(int32_t offset) {
+    emit(0x89);
+    emitFrameOperand(kEax, offset);
+}
+
+void X64Assembler::loadArgument(int32_t index) {
+    // mov eax, [rdi + disp32]: mod = 10, rm = 111 (rdi).
+    emit(0x8B);
+    emit(0x87);
+    emit32(index * 4);
+}
+
+void X64Assembler::pushAccumulator() { emit(0x50); }
+
+void X64Assembler::popOperand() {
+    emit(0x89), emit(0xC1); // mov ecx, eax
+    emit(0x58);             // pop rax
+}
+
+void X64Assembler::loadOperandImmediate(int32_t value) {
+    emit(0xB8 + kEcx);
+    emit32(value);
+}
+
+void X64Assembler::loadOperandLocal(int32_t offset) {
+    emit(0x8B);
+    emitFrameOperand(kEcx, offset);
+}
+
+void X64Assembler::add() { emit(0x01), emit(0xC8); }
+
+void X64Assembler::addImmediate(int32_t value) {
+    emit(0x05);
+    emit32(value);
+}
+
+void X64Assembler::addLocal(int32_t offset) {
+    emit(0x03);
+    emitFrameOperand(kEax, offset);
+}
+
+void X64Assembler::subtract() { emit(0x29), emit(0xC8); }
+
+void X64Assembler::subtractImmediate(int32_t value) {
+    emit(0x2D);
+    emit32(value);
+}
+
+void X64Assembler::subtractLocal(int32_t offset) {
+    emit(0x2B);
+    emitFrameOperand(kEax, offset);
+}
+
+void X64Assembler::multiply() { emit(0x0F), emit(0xAF), emit(0xC1); }
+
+void X64Assembler::multiplyImmediate(int32_t value) {
+    emit(0x69), emit(0xC0); // imul eax, eax, imm32
+    emit32(value);
+}
+
+void X64Assembler::multiplyLocal(int32_t offset) {
+    emit(0x0F), emit(0xAF);
+    emitFrameOperand(kEax, offset);
+}
+
+void X64Assembler::divide() {
+    emit(0x99);             // cdq
+    emit(0xF7), emit(0xF9); // idiv ecx
+}
+
+void X64Assembler::negate() { emit(0xF7), emit(0xD8); }
+
+void X64Assembler::compare() { emit(0x39), emit(0xC8); }
+
+void X64Assembler::compareImmediate(int32_t value) {
+    emit(0x3D);
+    emit32(value);
+}
+
+void X64Assembler::compareLocal(int32_t offset) {
+    emit(0x3B);
+    emitFrameOperand(kEax, offset);
+}
+
+void X64Assembler::compareOperandImmediate(int32_t value) {
+    emit(0x81), emit(0xF8 | kEcx); // cmp r/m32, imm32 with /7
+    emit32(value);
+}
+
+void X64Assembler::setCondition(X64Condition condition) {
+    emit(0x0F), emit(0x90 | static_cast<uint8_t>(condition)), emit(0xC0); // setcc al
+    emit(0x0F), emit(0xB6), emit(0xC0);                                   // movzx eax, al
+}
+
+void X64Assembler::testAccumulator() { emit(0x85), emit(0xC0); }
+
+void X64Assembler::emitTarget(X64Label *label) {
+    if (label->position >= 0) {
+        emit32(static_cast<int32_t>(label->position - static_cast<int64_t>(code_.size() + 4)));
+    } else {
+        label->fixups.push_back(code_.size());
+        emit32(0);
+    }
+}
+
+void X64Assembler::jump(X64Label *label) {
+    emit(0xE9);
+    emitTarget(label);
+}
+
+void X64Assembler::jumpIf(X64Condition condition, X64Label *label) {
+    emit(0x0F), emit(0x80 | static_cast<uint8_t>(condition));
+    emitTarget(label);
+}
+
+void X64Assembler::bind(X64Label *label) {
+    label->position = static_cast<int64_t>(code_.size());
+    for (size_t fixup : label->fixups) {
+        auto rel = static_cast<uint32_t>(label->position - static_cast<int64_t>(fixup + 4));
+        for (int i = 0; i < 4; ++i) {
+            code_[fixup + i] = static_cast<uint8_t>(rel >> (8 * i));
+        }
+    }
+    label->fixups.clear();
+}
+
+} // namespace suplang
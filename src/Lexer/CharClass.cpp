@@ -0,0 +1,143 @@
+#include "Lexer/CharClass.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SUPLANG_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace suplang {
+
+namespace {
+
+template <CharClass kClass> const char *SkipScalar(const char *p, const char *end) {
+    while (p < end && HasCharClass(*p, kClass)) {
+        ++p;
+    }
+    return p;
+}
+
+const ScanKernels kScalarKernels = {"scalar", SkipScalar<kSpace>, SkipScalar<kIdent>, SkipScalar<kDigit>};
+
+#ifdef SUPLANG_HAVE_X86_SIMD
+
+// The vector classifiers compare signed bytes, so non-ASCII bytes (which are
+// negative) never fall inside an ASCII range.
+
+// SSE2 is part of the x86-64 baseline and needs no runtime check.
+inline __m128i InRange128(__m128i v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(hi + 1))));
+}
+
+inline __m128i Space128(__m128i v) {
+    return _mm_or_si128(InRange128(v, '\t', '\r'), _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+}
+
+inline __m128i Digit128(__m128i v) { return InRange128(v, '0', '9'); }
+
+inline __m128i Ident128(__m128i v) {
+    // Setting bit 5 folds upper case onto lower case.
+    __m128i letter = InRange128(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+    __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(letter, underscore), Digit128(v));
+}
+
+template <__m128i (*kMatch)(__m128i), CharClass kClass> const char *SkipSse2(const char *p, const char *end) {
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        unsigned misses = ~static_cast<unsigned>(_mm_movemask_epi8(kMatch(v))) & 0xffffu;
+        if (misses)
+            return p + __builtin_ctz(misses);
+        p += 16;
+    }
+    return SkipScalar<kClass>(p, end);
+}
+
+const ScanKernels kSse2Kernels = {"sse2", SkipSse2<Space128, kSpace>, SkipSse2<Ident128, kIdent>,
+                                  SkipSse2<Digit128, kDigit>};
+
+// AVX2 code is compiled for that target only, and chosen at runtime.
+#define SUPLANG_AVX2 __attribute__((target("avx2")))
+
+SUPLANG_AVX2 inline __m256i InRange256(__m256i v, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), v));
+}
+
+SUPLANG_AVX2 inline __m256i Digit256(__m256i v) { return InRange256(v, '0', '9'); }
+
+SUPLANG_AVX2 const char *SkipSpaceAvx2(const char *p, const char *end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i match = _mm256_or_si256(InRange256(v, '\t', '\r'), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+        uint32_t misses = ~static_cast<uint32_t>(_mm256_movemask_epi8(match));
+        if (misses)
+            return p + __builtin_ctz(misses);
+        p += 32;
+    }
+    return SkipSse2<Space128, kSpace>(p, end);
+}
+
+SUPLANG_AVX2 const char *SkipIdentAvx2(const char *p, const char *end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i letter = InRange256(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+        __m256i underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+        __m256i match = _mm256_or_si256(_mm256_or_si256(letter, underscore), Digit256(v));
+        uint32_t misses = ~static_cast<uint32_t>(_mm256_movemask_epi8(match));
+        if (misses)
+            return p + __builtin_ctz(misses);
+        p += 32;
+    }
+    return SkipSse2<Ident128, kIdent>(p, end);
+}
+
+SUPLANG_AVX2 const char *SkipDigitsAvx2(const char *p, const char *end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        uint32_t misses = ~static_cast<uint32_t>(_mm256_movemask_epi8(Digit256(v)));
+        if (misses)
+            return p + __builtin_ctz(misses);
+        p += 32;
+    }
+    return SkipSse2<Digit128, kDigit>(p, end);
+}
+
+#undef SUPLANG_AVX2
+
+const ScanKernels kAvx2Kernels = {"avx2", SkipSpaceAvx2, SkipIdentAvx2, SkipDigitsAvx2};
+
+#endif // SUPLANG_HAVE_X86_SIMD
+
+} // namespace
+
+const ScanKernels &ScalarScanKernels() { return kScalarKernels; }
+
+const ScanKernels *Sse2ScanKernels() {
+#ifdef SUPLANG_HAVE_X86_SIMD
+    return &kSse2Kernels;
+#else
+    return nullptr;
+#endif
+}
+
+const ScanKernels *Avx2ScanKernels() {
+#ifdef SUPLANG_HAVE_X86_SIMD
+    if (__builtin_cpu_supports("avx2"))
+        return &kAvx2Kernels;
+#endif
+    return nullptr;
+}
+
+const ScanKernels &DefaultScanKernels() {
+    static const ScanKernels *kernels = [] {
+        if (const ScanKernels *avx2 = Avx2ScanKernels())
+            return avx2;
+        if (const ScanKernels *sse2 = Sse2ScanKernels())
+            return sse2;
+        return &kScalarKernels;
+    }();
+    return *kernels;
+}
+
+} // namespace suplang
@@ -1,14 +1,20 @@
 #include "Lexer/Lexer.h"
 
-#include <cctype>
-#include <map>
+#include <algorithm>
+#include <array>
+#include <string_view>
 
 namespace suplang {
 
 namespace {
 
-// Map of keywords to their corresponding token types for quick lookup.
-const std::map<std::string, TokenType> kKeywords = {
+struct Keyword {
+    std::string_view text;
+    TokenType type;
+};
+
+// The keywords and their corresponding token types.
+constexpr Keyword kKeywords[] = {
     {"def", TokenType::DEF},       {"class", TokenType::CLASS}, {"struct", TokenType::STRUCT},
     {"return", TokenType::RETURN}, {"int32", TokenType::INT32}, {"float", TokenType::FLOAT},
     {"bool", TokenType::BOOL},     {"char", TokenType::CHAR},   {"list", TokenType::LIST},
@@ -16,9 +22,44 @@ const std::map<std::string, TokenType> kKeywords = {
     {"true", TokenType::TRUE},     {"false", TokenType::FALSE}, {"while", TokenType::WHILE}, // Added while keyword.
 };
 
+// A perfect hash over kKeywords: every keyword lands in its own bucket, so a
+// lookup is one hash and at most one comparison. The multipliers were found
+// by search and are checked at compile time below.
+constexpr size_t kKeywordBuckets = 32;
+
+constexpr size_t KeywordHash(std::string_view text) {
+    return (text.size() * 3 + static_cast<uint8_t>(text.front()) + static_cast<uint8_t>(text.back()) * 14) &
+           (kKeywordBuckets - 1);
+}
+
+constexpr std::array<Keyword, kKeywordBuckets> MakeKeywordTable() {
+    std::array<Keyword, kKeywordBuckets> table{};
+    for (const Keyword &keyword : kKeywords) {
+        table[KeywordHash(keyword.text)] = keyword;
+    }
+    return table;
+}
+
+constexpr std::array<Keyword, kKeywordBuckets> kKeywordTable = MakeKeywordTable();
+
+constexpr bool KeywordHashIsPerfect() {
+    for (const Keyword &keyword : kKeywords) {
+        if (kKeywordTable[KeywordHash(keyword.text)].text != keyword.text)
+            return false;
+    }
+    return true;
+}
+static_assert(KeywordHashIsPerfect(), "keyword hash has a collision; pick new multipliers");
+
+// Returns the keyword's token type, or IDENTIFIER if `text` is no keyword.
+TokenType LookupKeyword(std::string_view text) {
+    const Keyword &candidate = kKeywordTable[KeywordHash(text)];
+    return candidate.text == text ? candidate.type : TokenType::IDENTIFIER;
+}
+
 } // namespace
 
-Lexer::Lexer(const std::string &source) : source_(source) {
+Lexer::Lexer(std::string_view source, const ScanKernels &kernels) : source_(source), kernels_(kernels) {
     if (!source_.empty()) {
         current_char_ = source_[position_];
     } else {
@@ -26,14 +67,6 @@ Lexer::Lexer(const std::string &source) : source_(source) {
     }
 }
 
-// Other Lexer methods (advance, peekChar, skipWhitespace, etc.) are unchanged.
-// ... (rest of the file is identical to the previous version) ...
-
-// NOTE: For brevity, the unchanged parts of Lexer.cpp are omitted.
-// The only change is adding "while" to the kKeywords map.
-// The full file content from the previous response is still valid.
-// The provided stub is for context.
-
 void Lexer::advance() {
     position_++;
     if (position_ >= source_.length()) {
@@ -50,44 +83,70 @@ char Lexer::peekChar() {
     return source_[position_ + 1];
 }
 
+void Lexer::seek(const char *p) {
+    position_ = static_cast<size_t>(p - source_.data());
+    current_char_ = position_ < source_.length() ? source_[position_] : 0;
+}
+
+void Lexer::resumeAt(size_t offset, SourceLocation location) {
+    seek(source_.data() + std::min(offset, source_.size()));
+    line_ = location.line;
+    line_start_ = position_ - std::min<size_t>(position_, location.column > 0 ? location.column - 1 : 0);
+}
+
 void Lexer::skipWhitespace() {
-    while (current_char_ != 0 && isspace(current_char_)) {
-        advance();
+    const char *begin = source_.data() + position_;
+    const char *end = kernels_.skip_space(begin, source_.data() + source_.size());
+    // Newlines only occur in whitespace, so lines are counted here.
+    // Runs are short, so a plain loop beats a call to memchr.
+    for (const char *p = begin; p < end; ++p) {
+        if (*p == '\n') {
+            ++line_;
+            line_start_ = static_cast<size_t>(p + 1 - source_.data());
+        }
     }
+    seek(end);
 }
 
 Token Lexer::makeIdentifier() {
-    std::string ident;
-    while (current_char_ != 0 && (isalnum(current_char_) || current_char_ == '_')) {
-        ident += current_char_;
-        advance();
-    }
-
-    if (kKeywords.count(ident)) {
-        return {kKeywords.at(ident), ident};
+    size_t start = position_;
+    seek(kernels_.skip_ident(source_.data() + position_, source_.data() + source_.size()));
+
+    Token token = makeToken(TokenType::IDENTIFIER, start);
+    std::string_view ident = text(token);
+    token.type = LookupKeyword(ident);
+    if (token.type == TokenType::IDENTIFIER) {
+        token.symbol = Intern(ident);
     }
-    return {TokenType::IDENTIFIER, ident};
+    return token;
 }
 
 Token Lexer::makeNumber() {
-    std::string num;
-    while (current_char_ != 0 && isdigit(current_char_)) {
-        num += current_char_;
-        advance();
-    }
-    return {TokenType::INTEGER_LITERAL, num};
+    size_t start = position_;
+    seek(kernels_.skip_digits(source_.data() + position_, source_.data() + source_.size()));
+    return makeToken(TokenType::INTEGER_LITERAL, start);
+}
+
+Token Lexer::makeToken(TokenType type, size_t start) const {
+    Token token;
+    token.type = type;
+    token.offset = static_cast<uint32_t>(start);
+    token.length = static_cast<uint32_t>(position_ - start);
+    token.location = {line_, static_cast<uint32_t>(start - line_start_ + 1)};
+    return token;
 }
 
 Token Lexer::nextToken() {
     while (current_char_ != 0) {
-        if (isspace(current_char_)) {
+        size_t start = position_;
+        if (HasCharClass(current_char_, kSpace)) {
             skipWhitespace();
             continue;
         }
-        if (isalpha(current_char_) || current_char_ == '_') {
+        if (HasCharClass(current_char_, kIdentStart)) {
             return makeIdentifier();
         }
-        if (isdigit(current_char_)) {
+        if (HasCharClass(current_char_, kDigit)) {
             return makeNumber();
         }
 
@@ -96,60 +155,59 @@ Token Lexer::nextToken() {
             if (peekChar() == '=') {
                 advance();
                 advance();
-                return {TokenType::EQUALS, "=="};
+                return makeToken(TokenType::EQUALS, start);
             }
             advance();
-            return {TokenType::ASSIGN, "="};
+            return makeToken(TokenType::ASSIGN, start);
         case ';':
             advance();
-            return {TokenType::SEMICOLON, ";"};
+            return makeToken(TokenType::SEMICOLON, start);
         case '(':
             advance();
-            return {TokenType::LPAREN, "("};
+            return makeToken(TokenType::LPAREN, start);
         case ')':
             advance();
-            return {TokenType::RPAREN, ")"};
+            return makeToken(TokenType::RPAREN, start);
         case '{':
             advance();
-            return {TokenType::LBRACE, "{"};
+            return makeToken(TokenType::LBRACE, start);
         case '}':
             advance();
-            return {TokenType::RBRACE, "}"};
+            return makeToken(TokenType::RBRACE, start);
         case ',':
             advance();
-            return {TokenType::COMMA, ","};
+            return makeToken(TokenType::COMMA, start);
         case '+':
             advance();
-            return {TokenType::PLUS, "+"};
+            return makeToken(TokenType::PLUS, start);
         case '-':
             advance();
-            return {TokenType::MINUS, "-"};
+            return makeToken(TokenType::MINUS, start);
         case '*':
             advance();
-            return {TokenType::ASTERISK, "*"};
+            return makeToken(TokenType::ASTERISK, start);
         case '/':
             advance();
-            return {TokenType::SLASH, "/"};
+            return makeToken(TokenType::SLASH, start);
         case '<':
             advance();
-            return {TokenType::LT, "<"};
+            return makeToken(TokenType::LT, start);
         case '>':
             advance();
-            return {TokenType::GT, ">"};
+            return makeToken(TokenType::GT, start);
         case '!':
             if (peekChar() == '=') {
                 advance();
                 advance();
-                return {TokenType::NOT_EQUALS, "!="};
+                return makeToken(TokenType::NOT_EQUALS, start);
             }
             break;
         }
 
-        Token illegal_token = {TokenType::ILLEGAL, std::string(1, current_char_)};
         advance();
-        return illegal_token;
+        return makeToken(TokenType::ILLEGAL, start);
     }
-    return {TokenType::END_OF_FILE, ""};
+    return makeToken(TokenType::END_OF_FILE, position_);
 }
 
 } // namespace suplang
\ No newline at end of file
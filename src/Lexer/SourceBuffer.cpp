@@ -0,0 +1,59 @@
+#include "Lexer/SourceBuffer.h"
+
+#include <fstream>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SUPLANG_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace suplang {
+
+std::unique_ptr<SourceBuffer> SourceBuffer::FromString(std::string text) {
+    std::unique_ptr<SourceBuffer> buffer(new SourceBuffer());
+    buffer->owned_ = std::move(text);
+    buffer->text_ = buffer->owned_;
+    return buffer;
+}
+
+std::unique_ptr<SourceBuffer> SourceBuffer::FromFile(const std::string &path) {
+#ifdef SUPLANG_HAVE_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        size_t size = static_cast<size_t>(info.st_size);
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            close(fd);
+            std::unique_ptr<SourceBuffer> buffer(new SourceBuffer());
+            buffer->mapping_ = mapping;
+            buffer->mapping_size_ = size;
+            buffer->text_ = std::string_view(static_cast<const char *>(mapping), size);
+            return buffer;
+        }
+    }
+    // Empty files, pipes and failed mappings are read the ordinary way.
+    close(fd);
+#endif
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return nullptr;
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return FromString(contents.str());
+}
+
+SourceBuffer::~SourceBuffer() {
+#ifdef SUPLANG_HAVE_MMAP
+    if (mapping_)
+        munmap(mapping_, mapping_size_);
+#endif
+}
+
+} // namespace suplang
@@ -0,0 +1,81 @@
+#include "Lexer/Symbol.h"
+
+namespace suplang {
+
+namespace {
+
+constexpr size_t kInitialBuckets = 64;
+
+// 32-bit FNV-1a.
+uint32_t HashName(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+} // namespace
+
+SymbolTable &SymbolTable::Global() {
+    static SymbolTable table;
+    return table;
+}
+
+Symbol SymbolTable::intern(std::string_view name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (buckets_.empty()) {
+        buckets_.assign(kInitialBuckets, kNoSymbol);
+    }
+
+    uint32_t hash = HashName(name);
+    size_t bucket = probe(name, hash);
+    if (buckets_[bucket] != kNoSymbol)
+        return buckets_[bucket];
+
+    Symbol symbol = static_cast<Symbol>(names_.size());
+    names_.emplace_back(name);
+    hashes_.push_back(hash);
+    buckets_[bucket] = symbol;
+    // Keep the load factor at or below one half.
+    if (names_.size() * 2 > buckets_.size()) {
+        grow();
+    }
+    return symbol;
+}
+
+Symbol SymbolTable::find(std::string_view name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (buckets_.empty())
+        return kNoSymbol;
+    return buckets_[probe(name, HashName(name))];
+}
+
+const std::string &SymbolTable::name(Symbol symbol) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_[symbol];
+}
+
+size_t SymbolTable::probe(std::string_view name, uint32_t hash) const {
+    size_t mask = buckets_.size() - 1;
+    for (size_t bucket = hash & mask;; bucket = (bucket + 1) & mask) {
+        Symbol symbol = buckets_[bucket];
+        if (symbol == kNoSymbol || (hashes_[symbol] == hash && names_[symbol] == name))
+            return bucket;
+    }
+}
+
+void SymbolTable::grow() {
+    buckets_.assign(buckets_.size() * 2, kNoSymbol);
+    size_t mask = buckets_.size() - 1;
+    for (Symbol symbol = 0; symbol < names_.size(); ++symbol) {
+        size_t bucket = hashes_[symbol] & mask;
+        while (buckets_[bucket] != kNoSymbol) {
+            bucket = (bucket + 1) & mask;
+        }
+        buckets_[bucket] = symbol;
+    }
+}
+
+} // namespace suplang
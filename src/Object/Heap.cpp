@@ -0,0 +1,148 @@
+#include "Object/Heap.h"
+
+// The collector traces through environments and closure-compiled
+// functions, so it needs their definitions.
+#include "Interpreter/ClosureCompiler.h"
+#include "Interpreter/Environment.h"
+
+#include <algorithm>
+
+namespace suplang {
+
+Heap::~Heap() {
+    while (objects_) {
+        Object *next = objects_->next;
+        Free(objects_);
+        objects_ = next;
+    }
+}
+
+size_t Heap::BlockSize(const Object *object) {
+    switch (object->type) {
+    case ObjectType::FUNCTION:
+        return sizeof(FunctionObject);
+    case ObjectType::CLOSURE_FUNCTION:
+        return sizeof(ClosureFunctionObject);
+    case ObjectType::ENVIRONMENT:
+        return sizeof(Environment);
+    case ObjectType::CELL:
+        return sizeof(Cell);
+    default:
+        return sizeof(Object);
+    }
+}
+
+size_t Heap::SizeOf(const Object *object) {
+    size_t size = BlockSize(object);
+    switch (object->type) {
+    case ObjectType::FUNCTION:
+        size += static_cast<const FunctionObject *>(object)->upvalues.capacity() * sizeof(Cell *);
+        break;
+    case ObjectType::CLOSURE_FUNCTION:
+        size += static_cast<const ClosureFunctionObject *>(object)->upvalues.capacity() * sizeof(Cell *);
+        break;
+    case ObjectType::ENVIRONMENT:
+        size += static_cast<const Environment *>(object)->slotCount() * sizeof(Value);
+        break;
+    default:
+        break;
+    }
+    return size;
+}
+
+void Heap::Free(Object *object) {
+    size_t size = BlockSize(object);
+    object->~Object();
+    SlabPool::Local().deallocate(object, size);
+}
+
+void Heap::markObject(Object *object) {
+    if (!object || object->marked)
+        return;
+    object->marked = true;
+    gray_.push_back(object);
+}
+
+void Heap::blacken(Object *object) {
+    switch (object->type) {
+    case ObjectType::FUNCTION:
+        for (Cell *cell : static_cast<FunctionObject *>(object)->upvalues) {
+            markObject(cell);
+        }
+        break;
+    case ObjectType::CLOSURE_FUNCTION:
+        for (Cell *cell : static_cast<ClosureFunctionObject *>(object)->upvalues) {
+            markObject(cell);
+        }
+        break;
+    case ObjectType::ENVIRONMENT:
+        for (const Value &value : static_cast<Environment *>(object)->slots()) {
+            markValue(value);
+        }
+        break;
+    case ObjectType::CELL:
+        markValue(static_cast<Cell *>(object)->value);
+        break;
+    default:
+        // Compiled functions refer only to their prototypes.
+        break;
+    }
+}
+
+void Heap::collect() {
+    auto start = std::chrono::steady_clock::now();
+
+    if (root_marker_) {
+        root_marker_(*this);
+    }
+    // An explicit worklist instead of recursion: chains of cells and closures
+    // can be arbitrarily deep.
+    while (!gray_.empty()) {
+        Object *object = gray_.back();
+        gray_.pop_back();
+        blacken(object);
+    }
+    sweep();
+
+    next_gc_ = std::max(options_.initial_threshold, static_cast<size_t>(bytes_allocated_ * options_.growth_factor));
+
+    auto pause = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    ++stats_.collections;
+    stats_.total_pause += pause;
+    stats_.max_pause = std::max(stats_.max_pause, pause);
+}
+
+void Heap::sweep() {
+    size_t live_bytes = 0;
+    Object **link = &objects_;
+    while (Object *object = *link) {
+        if (object->marked) {
+            object->marked = false;
+            live_bytes += SizeOf(object);
+            link = &object->next;
+        } else {
+            *link = object->next;
+            ++stats_.objects_freed;
+            Free(object);
+        }
+    }
+    // Environments and closures may have grown since they were allocated, so the live size
+    // is recounted rather than derived from the bytes freed.
+    if (bytes_allocated_ > live_bytes) {
+        stats_.bytes_freed += bytes_allocated_ - live_bytes;
+    }
+    bytes_allocated_ = live_bytes;
+}
+
+void PrintGcStats(const GcStats &stats, size_t bytes_live, std::ostream &out) {
+    auto millis = [](std::chrono::nanoseconds ns) { return std::chrono::duration<double, std::milli>(ns).count(); };
+    out << "collections:       " << stats.collections << "\n";
+    out << "objects allocated: " << stats.objects_allocated << "\n";
+    out << "objects freed:     " << stats.objects_freed << "\n";
+    out << "bytes freed:       " << stats.bytes_freed << "\n";
+    out << "bytes live:        " << bytes_live << "\n";
+    out << "total pause:       " << millis(stats.total_pause) << " ms\n";
+    out << "max pause:         " << millis(stats.max_pause) << " ms\n";
+}
+
+} // namespace suplang
@@ -0,0 +1,34 @@
+#include "Object/SlabPool.h"
+
+#include <ostream>
+
+namespace suplang {
+
+SlabPool &SlabPool::Local() {
+    thread_local SlabPool pool;
+    return pool;
+}
+
+void *SlabPool::carve(size_t size_class) {
+    size_t block_size = (size_class + 1) * kGranularity;
+    Region &region = regions_[size_class];
+    if (static_cast<size_t>(region.end - region.next) < block_size) {
+        // Slabs come from operator new[], so every block is 16-byte aligned.
+        slabs_.push_back(std::make_unique<char[]>(kSlabSize));
+        stats_.reserved_bytes += kSlabSize;
+        region.next = slabs_.back().get();
+        region.end = region.next + kSlabSize;
+    }
+    void *block = region.next;
+    region.next += block_size;
+    return block;
+}
+
+void PrintSlabStats(const SlabStats &stats, std::ostream &out) {
+    out << "blocks allocated:  " << stats.allocated << "\n";
+    out << "blocks recycled:   " << stats.recycled << "\n";
+    out << "blocks live:       " << stats.live << "\n";
+    out << "slab bytes:        " << stats.reserved_bytes << "\n";
+}
+
+} // namespace suplang
@@ -0,0 +1,213 @@
+#include "Optimizer/ConstantFolder.h"
+
+#include "Object/Value.h"
+#include "VM/Locals.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace suplang {
+
+namespace {
+// Sets `*truthy` and returns true if `node` is a literal.
+bool ConstantTruthiness(const ExpressionNode *node, bool *truthy) {
+    if (auto bl = NodeCast<BooleanLiteralNode>(node)) {
+        *truthy = bl->value;
+        return true;
+    }
+    if (NodeCast<NumberLiteralNode>(node)) {
+        // Every integer, including 0, is truthy.
+        *truthy = true;
+        return true;
+    }
+    return false;
+}
+
+// Returns true if `node` always evaluates to an integer or null, the only
+// values for which an arithmetic identity leaves the operand unchanged.
+bool IsArithmetic(const ExpressionNode *node) {
+    if (NodeCast<NumberLiteralNode>(node))
+        return true;
+    if (auto pe = NodeCast<PrefixExpressionNode>(node))
+        return pe->op == Operator::SUBTRACT;
+    if (auto ie = NodeCast<InfixExpressionNode>(node)) {
+        switch (ie->op) {
+        case Operator::ADD:
+        case Operator::SUBTRACT:
+        case Operator::MULTIPLY:
+        case Operator::DIVIDE:
+            return true;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+bool IsNumber(const ExpressionNode *node, int32_t value) {
+    auto nl = NodeCast<NumberLiteralNode>(node);
+    return nl && nl->value == value;
+}
+
+// Returns true if `node` declares or assigns any name.
+bool BindsNames(StatementNode *node) {
+    std::vector<Symbol> names;
+    CollectLocals(node, &names);
+    return !names.empty();
+}
+
+} // namespace
+
+void ConstantFolder::fold(ProgramNode *program) { foldStatements(program->statements); }
+
+void ConstantFolder::foldFunction(FunctionLiteralNode *function) {
+    if (function->body)
+        foldStatements(function->body->statements);
+}
+
+void ConstantFolder::foldStatements(const ArenaArray<StatementNode *> &statements) {
+    for (auto &stmt : statements) {
+        stmt = foldStatement(stmt);
+    }
+}
+
+StatementNode *ConstantFolder::foldStatement(StatementNode *node) {
+    if (auto es = NodeCast<ExpressionStatementNode>(node)) {
+        es->expression = foldExpression(es->expression);
+    } else if (auto vd = NodeCast<VarDeclNode>(node)) {
+        vd->initialValue = foldExpression(vd->initialValue);
+    } else if (auto rs = NodeCast<ReturnStatementNode>(node)) {
+        rs->return_value = foldExpression(rs->return_value);
+    } else if (auto bs = NodeCast<BlockStatementNode>(node)) {
+        foldStatements(bs->statements);
+    } else if (auto is = NodeCast<IfStatementNode>(node)) {
+        return foldIfStatement(is);
+    } else if (auto ws = NodeCast<WhileStatementNode>(node)) {
+        return foldWhileStatement(ws);
+    }
+    return node;
+}
+
+StatementNode *ConstantFolder::foldIfStatement(IfStatementNode *node) {
+    node->condition = foldExpression(node->condition);
+    foldStatements(node->consequence->statements);
+    if (node->alternative) {
+        node->alternative = foldStatement(node->alternative);
+    }
+
+    bool truthy;
+    if (!ConstantTruthiness(node->condition, &truthy))
+        return node;
+    StatementNode *taken = truthy ? node->consequence : node->alternative;
+    StatementNode *dropped = truthy ? node->alternative : node->consequence;
+    if (dropped && BindsNames(dropped))
+        return node;
+    // Blocks do not open scopes, so the taken branch can stand in for the
+    // whole statement; its completion value is the statement's.
+    return taken ? taken : emptyBlock(node);
+}
+
+StatementNode *ConstantFolder::foldWhileStatement(WhileStatementNode *node) {
+    node->condition = foldExpression(node->condition);
+    foldStatements(node->body->statements);
+
+    bool truthy;
+    if (ConstantTruthiness(node->condition, &truthy) && !truthy && !BindsNames(node->body))
+        return emptyBlock(node);
+    return node;
+}
+
+ExpressionNode *ConstantFolder::foldExpression(ExpressionNode *node) {
+    if (auto ie = NodeCast<InfixExpressionNode>(node))
+        return foldInfixExpression(ie);
+    if (auto pe = NodeCast<PrefixExpressionNode>(node))
+        return foldPrefixExpression(pe);
+    if (auto ce = NodeCast<CallExpressionNode>(node)) {
+        ce->function = foldExpression(ce->function);
+        for (auto &arg : ce->arguments) {
+            arg = foldExpression(arg);
+        }
+    } else if (auto fl = NodeCast<FunctionLiteralNode>(node)) {
+        if (fl->body)
+            foldStatements(fl->body->statements);
+    }
+    return node;
+}
+
+ExpressionNode *ConstantFolder::foldInfixExpression(InfixExpressionNode *node) {
+    // The target of an assignment is a name, not a value to fold.
+    if (node->op != Operator::ASSIGN) {
+        node->left = foldExpression(node->left);
+    }
+    node->right = foldExpression(node->right);
+
+    auto left = NodeCast<NumberLiteralNode>(node->left);
+    auto right = NodeCast<NumberLiteralNode>(node->right);
+    if (left && right) {
+        int32_t a = left->value;
+        int32_t b = right->value;
+        switch (node->op) {
+        case Operator::ADD:
+            return replace<NumberLiteralNode>(node, Wrap(static_cast<uint32_t>(a) + static_cast<uint32_t>(b)));
+        case Operator::SUBTRACT:
+            return replace<NumberLiteralNode>(node, Wrap(static_cast<uint32_t>(a) - static_cast<uint32_t>(b)));
+        case Operator::MULTIPLY:
+            return replace<NumberLiteralNode>(node, Wrap(static_cast<uint32_t>(a) * static_cast<uint32_t>(b)));
+        case Operator::DIVIDE:
+            if (b == 0)
+                return node;
+            return replace<NumberLiteralNode>(node, Divide(a, b));
+        case Operator::LESS:
+            return replace<BooleanLiteralNode>(node, a < b);
+        case Operator::GREATER:
+            return replace<BooleanLiteralNode>(node, a > b);
+        case Operator::EQUAL:
+            return replace<BooleanLiteralNode>(node, a == b);
+        case Operator::NOT_EQUAL:
+            return replace<BooleanLiteralNode>(node, a != b);
+        case Operator::ASSIGN:
+            return node;
+        }
+    }
+
+    switch (node->op) {
+    case Operator::ADD:
+        if (IsNumber(node->right, 0) && IsArithmetic(node->left))
+            return node->left;
+        if (IsNumber(node->left, 0) && IsArithmetic(node->right))
+            return node->right;
+        break;
+    case Operator::SUBTRACT:
+        if (IsNumber(node->right, 0) && IsArithmetic(node->left))
+            return node->left;
+        break;
+    case Operator::MULTIPLY:
+        if (IsNumber(node->right, 1) && IsArithmetic(node->left))
+            return node->left;
+        if (IsNumber(node->left, 1) && IsArithmetic(node->right))
+            return node->right;
+        break;
+    case Operator::DIVIDE:
+        if (IsNumber(node->right, 1) && IsArithmetic(node->left))
+            return node->left;
+        break;
+    default:
+        break;
+    }
+    return node;
+}
+
+ExpressionNode *ConstantFolder::foldPrefixExpression(PrefixExpressionNode *node) {
+    node->right = foldExpression(node->right);
+    auto operand = NodeCast<NumberLiteralNode>(node->right);
+    if (operand && node->op == Operator::SUBTRACT) {
+        return replace<NumberLiteralNode>(node, Wrap(0u - static_cast<uint32_t>(operand->value)));
+    }
+    return node;
+}
+
+BlockStatementNode *ConstantFolder::emptyBlock(const ASTNode *replaced) {
+    return replace<BlockStatementNode>(replaced, ArenaArray<StatementNode *>());
+}
+
+} // namespace suplang
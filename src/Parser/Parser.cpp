@@ -1,19 +1,71 @@
 #include "Parser/Parser.h"
 
+#include <array>
+#include <cassert>
+#include <charconv>
 #include <iostream>
+#include <vector>
 
 namespace suplang {
 
-Parser::Parser(Lexer &lexer) : lexer_(lexer) {
-    // Sets up the precedence table for infix operators.
-    precedences_ = {
-        {TokenType::ASSIGN, Precedence::EQUALS},     {TokenType::EQUALS, Precedence::EQUALS},
-        {TokenType::NOT_EQUALS, Precedence::EQUALS}, {TokenType::LT, Precedence::LESSGREATER},
-        {TokenType::GT, Precedence::LESSGREATER},    {TokenType::PLUS, Precedence::SUM},
-        {TokenType::MINUS, Precedence::SUM},         {TokenType::SLASH, Precedence::PRODUCT},
-        {TokenType::ASTERISK, Precedence::PRODUCT},  {TokenType::LPAREN, Precedence::CALL},
-    };
+namespace {
 
+constexpr size_t kTokenTypeCount = static_cast<size_t>(TokenType::END_OF_FILE) + 1;
+
+// The precedence of every token type as an infix operator, indexed by type.
+// Tokens that cannot continue an expression have LOWEST.
+constexpr std::array<Precedence, kTokenTypeCount> MakePrecedenceTable() {
+    std::array<Precedence, kTokenTypeCount> table{};
+    for (auto &precedence : table) {
+        precedence = Precedence::LOWEST;
+    }
+    table[static_cast<size_t>(TokenType::ASSIGN)] = Precedence::EQUALS;
+    table[static_cast<size_t>(TokenType::EQUALS)] = Precedence::EQUALS;
+    table[static_cast<size_t>(TokenType::NOT_EQUALS)] = Precedence::EQUALS;
+    table[static_cast<size_t>(TokenType::LT)] = Precedence::LESSGREATER;
+    table[static_cast<size_t>(TokenType::GT)] = Precedence::LESSGREATER;
+    table[static_cast<size_t>(TokenType::PLUS)] = Precedence::SUM;
+    table[static_cast<size_t>(TokenType::MINUS)] = Precedence::SUM;
+    table[static_cast<size_t>(TokenType::SLASH)] = Precedence::PRODUCT;
+    table[static_cast<size_t>(TokenType::ASTERISK)] = Precedence::PRODUCT;
+    table[static_cast<size_t>(TokenType::LPAREN)] = Precedence::CALL;
+    return table;
+}
+
+constexpr std::array<Precedence, kTokenTypeCount> kPrecedences = MakePrecedenceTable();
+
+// Maps an operator token to its AST operator. Only called for tokens that
+// have an operator precedence (other than the call parenthesis).
+Operator TokenOperator(TokenType type) {
+    switch (type) {
+    case TokenType::ASSIGN:
+        return Operator::ASSIGN;
+    case TokenType::PLUS:
+        return Operator::ADD;
+    case TokenType::MINUS:
+        return Operator::SUBTRACT;
+    case TokenType::ASTERISK:
+        return Operator::MULTIPLY;
+    case TokenType::SLASH:
+        return Operator::DIVIDE;
+    case TokenType::LT:
+        return Operator::LESS;
+    case TokenType::GT:
+        return Operator::GREATER;
+    case TokenType::EQUALS:
+        return Operator::EQUAL;
+    case TokenType::NOT_EQUALS:
+        return Operator::NOT_EQUAL;
+    default:
+        assert(false && "not an operator token");
+        __builtin_unreachable();
+    }
+}
+
+} // namespace
+
+Parser::Parser(Lexer &lexer, bool defer_function_bodies)
+    : lexer_(lexer), defer_function_bodies_(defer_function_bodies) {
     // Initializes the parser by reading the first two tokens.
     nextToken();
     nextToken();
@@ -25,30 +77,47 @@ void Parser::nextToken() {
     peek_token_ = lexer_.nextToken();
 }
 
+Precedence Parser::peekPrecedence() const { return kPrecedences[static_cast<size_t>(peek_token_.type)]; }
+
 // Asserts the type of the next token and advances if it matches.
 bool Parser::expectPeek(TokenType type) {
     if (peek_token_.type == type) {
         nextToken();
         return true;
     }
-    std::cerr << "Parser Error: Expected next token to be of type " << static_cast<int>(type) << ", got "
+    ++error_count_;
+    std::cerr << "Parser Error at " << peek_token_.location.line << ":" << peek_token_.location.column
+              << ": Expected next token to be of type " << static_cast<int>(type) << ", got "
               << static_cast<int>(peek_token_.type) << " instead.\n";
     return false;
 }
 
-std::unique_ptr<ProgramNode> Parser::parseProgram() {
-    auto program = std::make_unique<ProgramNode>();
+SyntaxTree Parser::parseProgram() {
+    auto arena = std::make_unique<Arena>();
+    arena_ = arena.get();
+    std::vector<StatementNode *> statements;
     while (current_token_.type != TokenType::END_OF_FILE) {
         auto stmt = parseStatement();
         if (stmt) {
-            program->statements.push_back(std::move(stmt));
+            statements.push_back(stmt);
         }
         nextToken();
     }
-    return program;
+    auto program = arena_->make<ProgramNode>(arena_->copyArray(statements));
+    arena_ = nullptr;
+    return SyntaxTree(std::move(arena), program);
+}
+
+BlockStatementNode *Parser::parseFunctionBody(Arena &arena) {
+    arena_ = &arena;
+    ++function_depth_;
+    BlockStatementNode *body = current_token_.type == TokenType::LBRACE ? parseBlockStatement() : nullptr;
+    --function_depth_;
+    arena_ = nullptr;
+    return body;
 }
 
-std::unique_ptr<StatementNode> Parser::parseStatement() {
+StatementNode *Parser::parseStatement() {
     switch (current_token_.type) {
     case TokenType::INT32:
     case TokenType::BOOL:
@@ -64,7 +133,8 @@ std::unique_ptr<StatementNode> Parser::parseStatement() {
     }
 }
 
-std::unique_ptr<StatementNode> Parser::parseWhileStatement() {
+StatementNode *Parser::parseWhileStatement() {
+    SourceLocation start = current_token_.location;
     if (!expectPeek(TokenType::LPAREN))
         return nullptr;
     nextToken();
@@ -74,32 +144,35 @@ std::unique_ptr<StatementNode> Parser::parseWhileStatement() {
     if (!expectPeek(TokenType::LBRACE))
         return nullptr;
     auto body = parseBlockStatement();
-    return std::make_unique<WhileStatementNode>(std::move(condition), std::move(body));
+    return make<WhileStatementNode>(start, condition, body);
 }
 
-std::unique_ptr<StatementNode> Parser::parseExpressionStatement() {
+StatementNode *Parser::parseExpressionStatement() {
+    SourceLocation start = current_token_.location;
     auto expr = parseExpression(Precedence::LOWEST);
-    auto stmt = std::make_unique<ExpressionStatementNode>(std::move(expr));
+    auto stmt = make<ExpressionStatementNode>(start, expr);
     if (peek_token_.type == TokenType::SEMICOLON) {
         nextToken();
     }
     return stmt;
 }
 
-std::unique_ptr<StatementNode> Parser::parseReturnStatement() {
+StatementNode *Parser::parseReturnStatement() {
+    SourceLocation start = current_token_.location;
     nextToken();
     auto return_value = parseExpression(Precedence::LOWEST);
     if (peek_token_.type == TokenType::SEMICOLON) {
         nextToken();
     }
-    return std::make_unique<ReturnStatementNode>(std::move(return_value));
+    return make<ReturnStatementNode>(start, return_value);
 }
 
-std::unique_ptr<StatementNode> Parser::parseVarDeclStatement() {
-    std::string type = current_token_.value;
+StatementNode *Parser::parseVarDeclStatement() {
+    SourceLocation start = current_token_.location;
+    std::string_view type = arena_->copyString(lexer_.text(current_token_));
     if (!expectPeek(TokenType::IDENTIFIER))
         return nullptr;
-    std::string name = current_token_.value;
+    Symbol name = current_token_.symbol;
     if (!expectPeek(TokenType::ASSIGN))
         return nullptr;
     nextToken();
@@ -107,10 +180,11 @@ std::unique_ptr<StatementNode> Parser::parseVarDeclStatement() {
     if (peek_token_.type == TokenType::SEMICOLON) {
         nextToken();
     }
-    return std::make_unique<VarDeclNode>(type, name, std::move(value));
+    return make<VarDeclNode>(start, type, name, value);
 }
 
-std::unique_ptr<StatementNode> Parser::parseIfStatement() {
+StatementNode *Parser::parseIfStatement() {
+    SourceLocation start = current_token_.location;
     if (!expectPeek(TokenType::LPAREN))
         return nullptr;
     nextToken();
@@ -120,7 +194,7 @@ std::unique_ptr<StatementNode> Parser::parseIfStatement() {
     if (!expectPeek(TokenType::LBRACE))
         return nullptr;
     auto consequence = parseBlockStatement();
-    std::unique_ptr<StatementNode> alternative = nullptr;
+    StatementNode *alternative = nullptr;
     if (peek_token_.type == TokenType::ELIF) {
         nextToken();
         alternative = parseIfStatement();
@@ -130,24 +204,25 @@ std::unique_ptr<StatementNode> Parser::parseIfStatement() {
             return nullptr;
         alternative = parseBlockStatement();
     }
-    return std::make_unique<IfStatementNode>(std::move(condition), std::move(consequence), std::move(alternative));
+    return make<IfStatementNode>(start, condition, consequence, alternative);
 }
 
-std::unique_ptr<BlockStatementNode> Parser::parseBlockStatement() {
-    auto block = std::make_unique<BlockStatementNode>();
+BlockStatementNode *Parser::parseBlockStatement() {
+    SourceLocation start = current_token_.location;
+    std::vector<StatementNode *> statements;
     nextToken();
     while (current_token_.type != TokenType::RBRACE && current_token_.type != TokenType::END_OF_FILE) {
         auto stmt = parseStatement();
         if (stmt) {
-            block->statements.push_back(std::move(stmt));
+            statements.push_back(stmt);
         }
         nextToken();
     }
-    return block;
+    return make<BlockStatementNode>(start, arena_->copyArray(statements));
 }
 
-std::unique_ptr<ExpressionNode> Parser::parseExpression(Precedence precedence) {
-    std::unique_ptr<ExpressionNode> left_exp;
+ExpressionNode *Parser::parseExpression(Precedence precedence) {
+    ExpressionNode *left_exp = nullptr;
     switch (current_token_.type) {
     case TokenType::IDENTIFIER:
         left_exp = parseIdentifier();
@@ -169,70 +244,95 @@ std::unique_ptr<ExpressionNode> Parser::parseExpression(Precedence precedence) {
         return nullptr;
     }
 
-    while (peek_token_.type != TokenType::SEMICOLON &&
-           precedence <
-               (precedences_.count(peek_token_.type) ? precedences_.at(peek_token_.type) : Precedence::LOWEST)) {
+    // Tokens without an infix precedence are LOWEST, so they end the loop.
+    while (peek_token_.type != TokenType::SEMICOLON && precedence < peekPrecedence()) {
         if (peek_token_.type == TokenType::LPAREN) {
             nextToken();
-            left_exp = parseCallExpression(std::move(left_exp));
-        } else if (precedences_.count(peek_token_.type)) {
-            nextToken();
-            left_exp = parseInfixExpression(std::move(left_exp));
+            left_exp = parseCallExpression(left_exp);
         } else {
-            return left_exp;
+            nextToken();
+            left_exp = parseInfixExpression(left_exp);
         }
     }
     return left_exp;
 }
 
-std::unique_ptr<ExpressionNode> Parser::parseFunctionLiteral() {
+ExpressionNode *Parser::parseFunctionLiteral() {
+    SourceLocation start = current_token_.location;
     if (!expectPeek(TokenType::IDENTIFIER))
         return nullptr;
+    Symbol name = current_token_.symbol;
     if (!expectPeek(TokenType::LPAREN))
         return nullptr;
     auto params = parseFunctionParameters();
     if (!expectPeek(TokenType::LBRACE))
         return nullptr;
+    if (defer_function_bodies_ && function_depth_ == 0) {
+        size_t body_offset = current_token_.offset;
+        SourceLocation body_location = current_token_.location;
+        skipBlock();
+        auto function = make<FunctionLiteralNode>(start, params, body_offset, body_location);
+        function->name = name;
+        return function;
+    }
+    ++function_depth_;
     auto body = parseBlockStatement();
-    return std::make_unique<FunctionLiteralNode>(std::move(params), std::move(body));
+    --function_depth_;
+    auto function = make<FunctionLiteralNode>(start, params, body);
+    function->name = name;
+    return function;
 }
 
-std::vector<Parameter> Parser::parseFunctionParameters() {
+void Parser::skipBlock() {
+    // Stops on the closing brace, as parseBlockStatement does.
+    int depth = 1;
+    while (depth > 0 && current_token_.type != TokenType::END_OF_FILE) {
+        nextToken();
+        if (current_token_.type == TokenType::LBRACE) {
+            ++depth;
+        } else if (current_token_.type == TokenType::RBRACE) {
+            --depth;
+        }
+    }
+}
+
+ArenaArray<Parameter> Parser::parseFunctionParameters() {
     std::vector<Parameter> params;
     if (peek_token_.type == TokenType::RPAREN) {
         nextToken();
-        return params;
+        return {};
     }
     nextToken();
-    Parameter p = {current_token_.value, ""};
+    Parameter p = {arena_->copyString(lexer_.text(current_token_)), kNoSymbol};
     if (!expectPeek(TokenType::IDENTIFIER))
         return {};
-    p.param_name = current_token_.value;
+    p.param_name = current_token_.symbol;
     params.push_back(p);
     while (peek_token_.type == TokenType::COMMA) {
         nextToken();
         nextToken();
-        Parameter p2 = {current_token_.value, ""};
+        Parameter p2 = {arena_->copyString(lexer_.text(current_token_)), kNoSymbol};
         if (!expectPeek(TokenType::IDENTIFIER))
             return {};
-        p2.param_name = current_token_.value;
+        p2.param_name = current_token_.symbol;
         params.push_back(p2);
     }
     if (!expectPeek(TokenType::RPAREN))
         return {};
-    return params;
+    return arena_->copyArray(params);
 }
 
-std::unique_ptr<ExpressionNode> Parser::parseCallExpression(std::unique_ptr<ExpressionNode> function) {
+ExpressionNode *Parser::parseCallExpression(ExpressionNode *function) {
+    SourceLocation start = function ? function->location : current_token_.location;
     auto args = parseCallArguments();
-    return std::make_unique<CallExpressionNode>(std::move(function), std::move(args));
+    return make<CallExpressionNode>(start, function, args);
 }
 
-std::vector<std::unique_ptr<ExpressionNode>> Parser::parseCallArguments() {
-    std::vector<std::unique_ptr<ExpressionNode>> args;
+ArenaArray<ExpressionNode *> Parser::parseCallArguments() {
+    std::vector<ExpressionNode *> args;
     if (peek_token_.type == TokenType::RPAREN) {
         nextToken();
-        return args;
+        return {};
     }
     nextToken();
     args.push_back(parseExpression(Precedence::LOWEST));
@@ -243,35 +343,45 @@ std::vector<std::unique_ptr<ExpressionNode>> Parser::parseCallArguments() {
     }
     if (!expectPeek(TokenType::RPAREN))
         return {};
-    return args;
+    return arena_->copyArray(args);
 }
 
-std::unique_ptr<ExpressionNode> Parser::parseIdentifier() {
-    return std::make_unique<IdentifierNode>(current_token_.value);
+ExpressionNode *Parser::parseIdentifier() {
+    return make<IdentifierNode>(current_token_.location, current_token_.symbol);
 }
 
-std::unique_ptr<ExpressionNode> Parser::parseIntegerLiteral() {
-    int32_t value = std::stoi(current_token_.value);
-    return std::make_unique<NumberLiteralNode>(value);
+ExpressionNode *Parser::parseIntegerLiteral() {
+    std::string_view digits = lexer_.text(current_token_);
+    int32_t value = 0;
+    auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if (error != std::errc() || end != digits.data() + digits.size()) {
+        ++error_count_;
+        std::cerr << "Parser Error at " << current_token_.location.line << ":" << current_token_.location.column
+                  << ": Integer literal " << digits << " is out of range.\n";
+        return nullptr;
+    }
+    return make<NumberLiteralNode>(current_token_.location, value);
 }
 
-std::unique_ptr<ExpressionNode> Parser::parseBoolean() {
-    return std::make_unique<BooleanLiteralNode>(current_token_.type == TokenType::TRUE);
+ExpressionNode *Parser::parseBoolean() {
+    return make<BooleanLiteralNode>(current_token_.location, current_token_.type == TokenType::TRUE);
 }
 
-std::unique_ptr<ExpressionNode> Parser::parsePrefixExpression() {
-    std::string op = current_token_.value;
+ExpressionNode *Parser::parsePrefixExpression() {
+    SourceLocation start = current_token_.location;
+    Operator op = TokenOperator(current_token_.type);
     nextToken();
     auto right = parseExpression(Precedence::PREFIX);
-    return std::make_unique<PrefixExpressionNode>(op, std::move(right));
+    return make<PrefixExpressionNode>(start, op, right);
 }
 
-std::unique_ptr<ExpressionNode> Parser::parseInfixExpression(std::unique_ptr<ExpressionNode> left) {
-    std::string op = current_token_.value;
-    Precedence current_precedence = precedences_[current_token_.type];
+ExpressionNode *Parser::parseInfixExpression(ExpressionNode *left) {
+    SourceLocation start = left ? left->location : current_token_.location;
+    Operator op = TokenOperator(current_token_.type);
+    Precedence current_precedence = kPrecedences[static_cast<size_t>(current_token_.type)];
     nextToken();
     auto right = parseExpression(current_precedence);
-    return std::make_unique<InfixExpressionNode>(std::move(left), op, std::move(right));
+    return make<InfixExpressionNode>(start, left, op, right);
 }
 
 } // namespace suplang
\ No newline at end of file
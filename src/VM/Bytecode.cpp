@@ -0,0 +1,117 @@
+#include "VM/Bytecode.h"
+
+#include <iomanip>
+
+namespace suplang {
+
+namespace {
+
+const char *OpName(OpCode op) {
+    switch (op) {
+    case OpCode::CONSTANT:
+        return "CONSTANT";
+    case OpCode::NIL:
+        return "NIL";
+    case OpCode::TRUE:
+        return "TRUE";
+    case OpCode::FALSE:
+        return "FALSE";
+    case OpCode::POP:
+        return "POP";
+    case OpCode::GET_LOCAL:
+        return "GET_LOCAL";
+    case OpCode::SET_LOCAL:
+        return "SET_LOCAL";
+    case OpCode::GET_GLOBAL:
+        return "GET_GLOBAL";
+    case OpCode::SET_GLOBAL:
+        return "SET_GLOBAL";
+    case OpCode::ADD:
+        return "ADD";
+    case OpCode::SUBTRACT:
+        return "SUBTRACT";
+    case OpCode::MULTIPLY:
+        return "MULTIPLY";
+    case OpCode::DIVIDE:
+        return "DIVIDE";
+    case OpCode::LESS:
+        return "LESS";
+    case OpCode::GREATER:
+        return "GREATER";
+    case OpCode::EQUAL:
+        return "EQUAL";
+    case OpCode::NOT_EQUAL:
+        return "NOT_EQUAL";
+    case OpCode::NEGATE:
+        return "NEGATE";
+    case OpCode::JUMP:
+        return "JUMP";
+    case OpCode::JUMP_IF_FALSE:
+        return "JUMP_IF_FALSE";
+    case OpCode::LOOP:
+        return "LOOP";
+    case OpCode::CALL:
+        return "CALL";
+    case OpCode::TAIL_CALL:
+        return "TAIL_CALL";
+    case OpCode::RETURN:
+        return "RETURN";
+    }
+    return "UNKNOWN";
+}
+
+bool HasOperand(OpCode op) {
+    switch (op) {
+    case OpCode::CONSTANT:
+    case OpCode::GET_LOCAL:
+    case OpCode::SET_LOCAL:
+    case OpCode::GET_GLOBAL:
+    case OpCode::SET_GLOBAL:
+    case OpCode::JUMP:
+    case OpCode::JUMP_IF_FALSE:
+    case OpCode::LOOP:
+    case OpCode::CALL:
+    case OpCode::TAIL_CALL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+void Disassemble(const FunctionProto &proto, std::ostream &out) {
+    out << "== " << proto.name << " (arity " << proto.arity << ", locals " << proto.num_locals << ") ==\n";
+    const auto &code = proto.chunk.code;
+    for (size_t offset = 0; offset < code.size();) {
+        auto op = static_cast<OpCode>(code[offset]);
+        out << std::setw(4) << std::setfill('0') << offset << std::setfill(' ') << "  " << OpName(op);
+        if (HasOperand(op)) {
+            uint16_t operand = static_cast<uint16_t>(code[offset + 1] | (code[offset + 2] << 8));
+            out << " " << operand;
+            if (op == OpCode::CONSTANT) {
+                const Value &constant = proto.chunk.constants[operand];
+                if (constant.isInteger()) {
+                    out << " (" << constant.asInteger() << ")";
+                }
+            } else if (op == OpCode::JUMP || op == OpCode::JUMP_IF_FALSE) {
+                out << " -> " << offset + 3 + operand;
+            } else if (op == OpCode::LOOP) {
+                out << " -> " << offset + 3 - operand;
+            }
+            offset += 3;
+        } else {
+            offset += 1;
+        }
+        out << "\n";
+    }
+
+    for (const Value &constant : proto.chunk.constants) {
+        if (constant.isObject() && constant.asObject()->type == ObjectType::COMPILED_FUNCTION) {
+            out << "\n";
+            Disassemble(*static_cast<CompiledFunctionObject *>(constant.asObject())->proto, out);
+        }
+    }
+}
+
+} // namespace suplang
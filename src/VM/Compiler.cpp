@@ -0,0 +1,341 @@
+#include "VM/Compiler.h"
+
+#include "VM/Locals.h"
+
+#include <iostream>
+#include <limits>
+
+namespace suplang {
+
+CompiledProgram Compiler::compile(ProgramNode *program) {
+    auto script = std::make_shared<FunctionProto>();
+    script->name = "<script>";
+    std::map<int32_t, uint16_t> integer_constants;
+    current_ = script.get();
+    locals_ = nullptr;
+    integer_constants_ = &integer_constants;
+
+    compileBlock(program->statements, true);
+    emitOp(OpCode::RETURN);
+
+    current_ = nullptr;
+    integer_constants_ = nullptr;
+    return {script, global_names_};
+}
+
+void Compiler::compileBlock(const ArenaArray<StatementNode *> &statements, bool want_value) {
+    if (statements.empty()) {
+        if (want_value)
+            emitOp(OpCode::NIL);
+        return;
+    }
+    // Only the last statement of a block can provide its completion value.
+    for (size_t i = 0; i < statements.size(); ++i) {
+        compileStatement(statements[i], want_value && i + 1 == statements.size());
+    }
+}
+
+void Compiler::compileStatement(StatementNode *node, bool want_value) {
+    if (auto es = NodeCast<ExpressionStatementNode>(node)) {
+        compileExpression(es->expression);
+    } else if (auto vd = NodeCast<VarDeclNode>(node)) {
+        compileExpression(vd->initialValue);
+        emitSet(vd->varName);
+    } else if (auto rs = NodeCast<ReturnStatementNode>(node)) {
+        // `return f(...)` inside a function reuses its frame, so that deep
+        // tail recursion runs in constant stack as in the interpreter. A
+        // callee that is not a function leaves null for the RETURN.
+        auto call = locals_ ? NodeCast<CallExpressionNode>(rs->return_value) : nullptr;
+        if (call) {
+            compileCall(call, OpCode::TAIL_CALL);
+        } else {
+            compileExpression(rs->return_value);
+        }
+        emitOp(OpCode::RETURN);
+        // Keep the stack balanced for the (unreachable) code that follows.
+        if (want_value)
+            emitOp(OpCode::NIL);
+        return;
+    } else if (auto is = NodeCast<IfStatementNode>(node)) {
+        compileIfStatement(is, want_value);
+        return;
+    } else if (auto ws = NodeCast<WhileStatementNode>(node)) {
+        compileWhileStatement(ws, want_value);
+        return;
+    } else if (auto bs = NodeCast<BlockStatementNode>(node)) {
+        compileBlock(bs->statements, want_value);
+        return;
+    } else {
+        emitOp(OpCode::NIL);
+    }
+
+    if (!want_value)
+        emitOp(OpCode::POP);
+}
+
+void Compiler::compileIfStatement(IfStatementNode *node, bool want_value) {
+    compileExpression(node->condition);
+    size_t else_jump = emitJump(OpCode::JUMP_IF_FALSE);
+    compileBlock(node->consequence->statements, want_value);
+    size_t end_jump = emitJump(OpCode::JUMP);
+
+    patchJump(else_jump);
+    if (node->alternative) {
+        compileStatement(node->alternative, want_value);
+    } else if (want_value) {
+        emitOp(OpCode::NIL);
+    }
+    patchJump(end_jump);
+}
+
+void Compiler::compileWhileStatement(WhileStatementNode *node, bool want_value) {
+    // The completion value of a loop is that of its last executed iteration,
+    // so a result slot is kept on the stack and replaced by every iteration.
+    if (want_value)
+        emitOp(OpCode::NIL);
+
+    size_t loop_start = current_->chunk.code.size();
+    compileExpression(node->condition);
+    size_t exit_jump = emitJump(OpCode::JUMP_IF_FALSE);
+    if (want_value)
+        emitOp(OpCode::POP);
+    compileBlock(node->body->statements, want_value);
+    emitLoop(loop_start);
+    patchJump(exit_jump);
+}
+
+void Compiler::compileExpression(ExpressionNode *node) {
+    if (!node) {
+        emitOp(OpCode::NIL);
+    } else if (auto nl = NodeCast<NumberLiteralNode>(node)) {
+        emitOp(OpCode::CONSTANT, integerConstant(nl->value));
+    } else if (auto bl = NodeCast<BooleanLiteralNode>(node)) {
+        emitOp(bl->value ? OpCode::TRUE : OpCode::FALSE);
+    } else if (auto id = NodeCast<IdentifierNode>(node)) {
+        emitGet(id->symbol);
+    } else if (auto ie = NodeCast<InfixExpressionNode>(node)) {
+        compileInfixExpression(ie);
+    } else if (auto pe = NodeCast<PrefixExpressionNode>(node)) {
+        compileExpression(pe->right);
+        if (pe->op == Operator::SUBTRACT) {
+            emitOp(OpCode::NEGATE);
+        } else {
+            emitOp(OpCode::POP);
+            emitOp(OpCode::NIL);
+        }
+    } else if (auto fl = NodeCast<FunctionLiteralNode>(node)) {
+        compileFunctionLiteral(fl);
+    } else if (auto ce = NodeCast<CallExpressionNode>(node)) {
+        compileCall(ce, OpCode::CALL);
+    } else {
+        emitOp(OpCode::NIL);
+    }
+}
+
+void Compiler::compileCall(CallExpressionNode *node, OpCode op) {
+    compileExpression(node->function);
+    for (const auto &arg : node->arguments) {
+        compileExpression(arg);
+    }
+    emitOp(op, node->arguments.size());
+}
+
+void Compiler::compileInfixExpression(InfixExpressionNode *node) {
+    if (node->op == Operator::ASSIGN) {
+        if (auto id = NodeCast<IdentifierNode>(node->left)) {
+            compileExpression(node->right);
+            emitSet(id->symbol);
+            return;
+        }
+    }
+
+    compileExpression(node->left);
+    compileExpression(node->right);
+
+    switch (node->op) {
+    case Operator::ADD:
+        emitOp(OpCode::ADD);
+        break;
+    case Operator::SUBTRACT:
+        emitOp(OpCode::SUBTRACT);
+        break;
+    case Operator::MULTIPLY:
+        emitOp(OpCode::MULTIPLY);
+        break;
+    case Operator::DIVIDE:
+        emitOp(OpCode::DIVIDE);
+        break;
+    case Operator::LESS:
+        emitOp(OpCode::LESS);
+        break;
+    case Operator::GREATER:
+        emitOp(OpCode::GREATER);
+        break;
+    case Operator::EQUAL:
+        emitOp(OpCode::EQUAL);
+        break;
+    case Operator::NOT_EQUAL:
+        emitOp(OpCode::NOT_EQUAL);
+        break;
+    case Operator::ASSIGN:
+        // Assignment to something other than a name evaluates both operands
+        // and produces null.
+        emitOp(OpCode::POP);
+        emitOp(OpCode::POP);
+        emitOp(OpCode::NIL);
+        break;
+    }
+}
+
+void Compiler::compileFunctionLiteral(FunctionLiteralNode *node) {
+    auto proto = std::make_shared<FunctionProto>();
+    proto->name = "<fn>";
+    proto->arity = node->parameters.size();
+    // Captured variables would need cells and upvalues, which the VM lacks;
+    // compiled as globals they would silently read the wrong variable.
+    if (!node->upvalues.empty()) {
+        std::cerr << "Compiler Error at " << node->location.line << ":" << node->location.column
+                  << ": Closures capturing local variables need the ast, jit or closure backend.\n";
+        ++error_count_;
+    }
+
+    FunctionProto *enclosing = current_;
+    std::map<Symbol, uint16_t> *enclosing_locals = locals_;
+    std::map<int32_t, uint16_t> *enclosing_constants = integer_constants_;
+    std::map<Symbol, uint16_t> locals;
+    std::map<int32_t, uint16_t> integer_constants;
+    current_ = proto.get();
+    locals_ = &locals;
+    integer_constants_ = &integer_constants;
+
+    for (const auto &param : node->parameters) {
+        declareLocal(param.param_name);
+    }
+    std::vector<Symbol> names;
+    CollectLocals(node->body, &names);
+    for (const auto &name : names) {
+        declareLocal(name);
+    }
+
+    if (node->body) {
+        compileBlock(node->body->statements, true);
+    } else {
+        emitOp(OpCode::NIL);
+    }
+    emitOp(OpCode::RETURN);
+
+    current_ = enclosing;
+    locals_ = enclosing_locals;
+    integer_constants_ = enclosing_constants;
+    auto function = std::make_unique<CompiledFunctionObject>(proto);
+    emitOp(OpCode::CONSTANT, addConstant(Value::FromObject(function.get())));
+    current_->chunk.objects.push_back(std::move(function));
+}
+
+void Compiler::declareLocal(Symbol name) {
+    if (locals_->count(name))
+        return;
+    if (locals_->size() > std::numeric_limits<uint16_t>::max()) {
+        std::cerr << "Compiler Error: Too many local variables in one function.\n";
+        ++error_count_;
+        return;
+    }
+    uint16_t slot = static_cast<uint16_t>(locals_->size());
+    (*locals_)[name] = slot;
+    current_->num_locals = locals_->size();
+}
+
+void Compiler::emitGet(Symbol name) {
+    if (locals_) {
+        auto it = locals_->find(name);
+        if (it != locals_->end()) {
+            emitOp(OpCode::GET_LOCAL, it->second);
+            return;
+        }
+    }
+    emitOp(OpCode::GET_GLOBAL, globalSlot(name));
+}
+
+void Compiler::emitSet(Symbol name) {
+    if (locals_) {
+        auto it = locals_->find(name);
+        if (it != locals_->end()) {
+            emitOp(OpCode::SET_LOCAL, it->second);
+            return;
+        }
+    }
+    emitOp(OpCode::SET_GLOBAL, globalSlot(name));
+}
+
+uint16_t Compiler::globalSlot(Symbol name) {
+    auto it = global_slots_.find(name);
+    if (it != global_slots_.end())
+        return it->second;
+    uint16_t slot = static_cast<uint16_t>(global_names_.size());
+    global_slots_[name] = slot;
+    global_names_.push_back(name);
+    return slot;
+}
+
+void Compiler::emitOp(OpCode op) { current_->chunk.code.push_back(static_cast<uint8_t>(op)); }
+
+void Compiler::emitOperand(size_t operand) {
+    if (operand > std::numeric_limits<uint16_t>::max()) {
+        std::cerr << "Compiler Error: Operand " << operand << " does not fit in 16 bits.\n";
+        ++error_count_;
+    }
+    current_->chunk.code.push_back(static_cast<uint8_t>(operand & 0xff));
+    current_->chunk.code.push_back(static_cast<uint8_t>((operand >> 8) & 0xff));
+}
+
+void Compiler::emitOp(OpCode op, size_t operand) {
+    emitOp(op);
+    emitOperand(operand);
+}
+
+uint16_t Compiler::integerConstant(int32_t value) {
+    auto it = integer_constants_->find(value);
+    if (it != integer_constants_->end())
+        return it->second;
+    uint16_t index = addConstant(Value::Integer(value));
+    (*integer_constants_)[value] = index;
+    return index;
+}
+
+uint16_t Compiler::addConstant(Value value) {
+    auto &constants = current_->chunk.constants;
+    if (constants.size() > std::numeric_limits<uint16_t>::max()) {
+        std::cerr << "Compiler Error: Too many constants in one function.\n";
+        ++error_count_;
+        return 0;
+    }
+    constants.push_back(std::move(value));
+    return static_cast<uint16_t>(constants.size() - 1);
+}
+
+// Emits a forward jump with a placeholder offset and returns the position of
+// that offset so it can be patched once the target is known.
+size_t Compiler::emitJump(OpCode op) {
+    emitOp(op);
+    emitOperand(0);
+    return current_->chunk.code.size() - 2;
+}
+
+void Compiler::patchJump(size_t operand_offset) {
+    auto &code = current_->chunk.code;
+    size_t jump = code.size() - (operand_offset + 2);
+    if (jump > std::numeric_limits<uint16_t>::max()) {
+        std::cerr << "Compiler Error: Jump offset too large.\n";
+        ++error_count_;
+    }
+    code[operand_offset] = static_cast<uint8_t>(jump & 0xff);
+    code[operand_offset + 1] = static_cast<uint8_t>((jump >> 8) & 0xff);
+}
+
+void Compiler::emitLoop(size_t loop_start) {
+    emitOp(OpCode::LOOP);
+    // The offset is measured from the end of this instruction.
+    emitOperand(current_->chunk.code.size() + 2 - loop_start);
+}
+
+} // namespace suplang
@@ -0,0 +1,52 @@
+#include "VM/Locals.h"
+
+#include <algorithm>
+
+namespace suplang {
+
+namespace {
+void AddName(Symbol name, std::vector<Symbol> *names) {
+    if (std::find(names->begin(), names->end(), name) == names->end()) {
+        names->push_back(name);
+    }
+}
+} // namespace
+
+void CollectLocals(const ASTNode *node, std::vector<Symbol> *names) {
+    if (!node)
+        return;
+
+    if (auto bs = NodeCast<BlockStatementNode>(node)) {
+        for (const auto &stmt : bs->statements)
+            CollectLocals(stmt, names);
+    } else if (auto es = NodeCast<ExpressionStatementNode>(node)) {
+        CollectLocals(es->expression, names);
+    } else if (auto vd = NodeCast<VarDeclNode>(node)) {
+        CollectLocals(vd->initialValue, names);
+        AddName(vd->varName, names);
+    } else if (auto rs = NodeCast<ReturnStatementNode>(node)) {
+        CollectLocals(rs->return_value, names);
+    } else if (auto is = NodeCast<IfStatementNode>(node)) {
+        CollectLocals(is->condition, names);
+        CollectLocals(is->consequence, names);
+        CollectLocals(is->alternative, names);
+    } else if (auto ws = NodeCast<WhileStatementNode>(node)) {
+        CollectLocals(ws->condition, names);
+        CollectLocals(ws->body, names);
+    } else if (auto ie = NodeCast<InfixExpressionNode>(node)) {
+        if (ie->op == Operator::ASSIGN) {
+            if (auto id = NodeCast<IdentifierNode>(ie->left))
+                AddName(id->symbol, names);
+        }
+        CollectLocals(ie->left, names);
+        CollectLocals(ie->right, names);
+    } else if (auto pe = NodeCast<PrefixExpressionNode>(node)) {
+        CollectLocals(pe->right, names);
+    } else if (auto ce = NodeCast<CallExpressionNode>(node)) {
+        CollectLocals(ce->function, names);
+        for (const auto &arg : ce->arguments)
+            CollectLocals(arg, names);
+    }
+}
+
+} // namespace suplang
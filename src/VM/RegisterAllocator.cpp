@@ -0,0 +1,238 @@
+#include "VM/RegisterAllocator.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <map>
+#include <queue>
+
+namespace suplang {
+
+namespace {
+
+// Calls `visit(operand, is_def)` for every register operand of `in`.
+// Constant-pool operands are skipped.
+template <typename Visitor> void ForEachRegister(RegInstruction &in, Visitor visit) {
+    auto use = [&](uint16_t &operand) {
+        if (!(operand & kConstantBit))
+            visit(operand, false);
+    };
+    auto def = [&](uint16_t &operand) { visit(operand, true); };
+
+    switch (in.op) {
+    case RegOpCode::MOVE:
+    case RegOpCode::NEGATE:
+    case RegOpCode::CALL:
+    case RegOpCode::TAIL_CALL:
+        use(in.b);
+        def(in.a);
+        break;
+    case RegOpCode::GET_GLOBAL:
+        def(in.a);
+        break;
+    case RegOpCode::SET_GLOBAL:
+    case RegOpCode::ARG:
+    case RegOpCode::RETURN:
+        use(in.a);
+        break;
+    case RegOpCode::ADD:
+    case RegOpCode::SUBTRACT:
+    case RegOpCode::MULTIPLY:
+    case RegOpCode::DIVIDE:
+    case RegOpCode::LESS:
+    case RegOpCode::GREATER:
+    case RegOpCode::EQUAL:
+    case RegOpCode::NOT_EQUAL:
+        use(in.b);
+        use(in.c);
+        def(in.a);
+        break;
+    case RegOpCode::JUMP_IF_FALSE:
+        use(in.b);
+        break;
+    case RegOpCode::JUMP_UNLESS_LESS:
+    case RegOpCode::JUMP_UNLESS_GREATER:
+    case RegOpCode::JUMP_UNLESS_EQUAL:
+    case RegOpCode::JUMP_UNLESS_NOT_EQUAL:
+        use(in.b);
+        use(in.c);
+        break;
+    case RegOpCode::JUMP:
+        break;
+    }
+}
+
+bool IsJump(RegOpCode op) {
+    switch (op) {
+    case RegOpCode::JUMP:
+    case RegOpCode::JUMP_IF_FALSE:
+    case RegOpCode::JUMP_UNLESS_LESS:
+    case RegOpCode::JUMP_UNLESS_GREATER:
+    case RegOpCode::JUMP_UNLESS_EQUAL:
+    case RegOpCode::JUMP_UNLESS_NOT_EQUAL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// A dense bit set over virtual registers, one per instruction.
+class LiveSets {
+  public:
+    LiveSets(size_t count, size_t num_bits) : words_((num_bits + 63) / 64), bits_(count * words_, 0) {}
+
+    uint64_t *at(size_t index) { return &bits_[index * words_]; }
+    size_t words() const { return words_; }
+
+  private:
+    size_t words_;
+    std::vector<uint64_t> bits_;
+};
+
+struct Interval {
+    int start = INT_MAX;
+    int end = -1;
+};
+
+// Computes, for every instruction, the set of virtual registers live on
+// entry, by iterating the backward dataflow equations to a fixed point.
+LiveSets ComputeLiveness(std::vector<RegInstruction> &code, size_t num_virtual) {
+    size_t n = code.size();
+    LiveSets live_in(n, num_virtual);
+    LiveSets uses(n, num_virtual);
+    LiveSets defs(n, num_virtual);
+    for (size_t i = 0; i < n; ++i) {
+        ForEachRegister(code[i], [&](uint16_t &reg, bool is_def) {
+            uint64_t *set = is_def ? defs.at(i) : uses.at(i);
+            set[reg / 64] |= uint64_t{1} << (reg % 64);
+        });
+    }
+
+    std::vector<uint64_t> live_out(live_in.words());
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = n; i-- > 0;) {
+            const RegInstruction &in = code[i];
+            std::fill(live_out.begin(), live_out.end(), 0);
+            auto merge = [&](size_t successor) {
+                if (successor >= n)
+                    return;
+                const uint64_t *in_set = live_in.at(successor);
+                for (size_t w = 0; w < live_out.size(); ++w)
+                    live_out[w] |= in_set[w];
+            };
+            if (in.op != RegOpCode::RETURN && in.op != RegOpCode::JUMP)
+                merge(i + 1);
+            if (IsJump(in.op))
+                merge(in.a);
+
+            uint64_t *set = live_in.at(i);
+            const uint64_t *use = uses.at(i);
+            const uint64_t *def = defs.at(i);
+            for (size_t w = 0; w < live_out.size(); ++w) {
+                uint64_t updated = use[w] | (live_out[w] & ~def[w]);
+                if (updated != set[w]) {
+                    set[w] = updated;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return live_in;
+}
+
+} // namespace
+
+void AllocateRegisters(RegisterProto *proto, size_t num_virtual_registers) {
+    auto &code = proto->code;
+    LiveSets live_in = ComputeLiveness(code, num_virtual_registers);
+
+    // Each interval is the hull of the positions where a register is live or
+    // referenced. Parameters, and locals that may be read before they are
+    // written, are live on entry and start before the first instruction.
+    std::vector<Interval> intervals(num_virtual_registers);
+    for (size_t i = 0; i < code.size(); ++i) {
+        int pos = static_cast<int>(i);
+        ForEachRegister(code[i], [&](uint16_t &reg, bool) {
+            intervals[reg].start = std::min(intervals[reg].start, pos);
+            intervals[reg].end = std::max(intervals[reg].end, pos);
+        });
+        const uint64_t *set = live_in.at(i);
+        for (size_t reg = 0; reg < num_virtual_registers; ++reg) {
+            if (set[reg / 64] & (uint64_t{1} << (reg % 64))) {
+                intervals[reg].start = std::min(intervals[reg].start, pos);
+                intervals[reg].end = std::max(intervals[reg].end, pos);
+            }
+        }
+    }
+    if (!code.empty()) {
+        const uint64_t *entry = live_in.at(0);
+        for (size_t reg = 0; reg < num_virtual_registers; ++reg) {
+            if (entry[reg / 64] & (uint64_t{1} << (reg % 64)))
+                intervals[reg].start = -1;
+        }
+    }
+    for (size_t reg = 0; reg < proto->arity && reg < num_virtual_registers; ++reg) {
+        intervals[reg].start = -1;
+        intervals[reg].end = std::max(intervals[reg].end, 0);
+    }
+
+    std::vector<uint16_t> order;
+    for (size_t reg = 0; reg < num_virtual_registers; ++reg) {
+        if (intervals[reg].end >= 0)
+            order.push_back(static_cast<uint16_t>(reg));
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](uint16_t a, uint16_t b) { return intervals[a].start < intervals[b].start; });
+
+    // Linear scan. An interval may reuse a register whose last use is the
+    // instruction that starts it, since every instruction reads its operands
+    // before writing its result. With parameters processed first and nothing
+    // yet free, they receive registers 0..arity-1 in order.
+    std::vector<uint16_t> assignment(num_virtual_registers, 0);
+    std::multimap<int, uint16_t> active; // end -> physical register
+    std::priority_queue<uint16_t, std::vector<uint16_t>, std::greater<uint16_t>> free_registers;
+    uint16_t next_register = 0;
+    for (uint16_t reg : order) {
+        const Interval &interval = intervals[reg];
+        while (!active.empty() && active.begin()->first <= interval.start) {
+            free_registers.push(active.begin()->second);
+            active.erase(active.begin());
+        }
+        uint16_t physical;
+        if (free_registers.empty()) {
+            physical = next_register++;
+        } else {
+            physical = free_registers.top();
+            free_registers.pop();
+        }
+        assignment[reg] = physical;
+        active.emplace(interval.end, physical);
+    }
+    proto->num_registers = std::max<size_t>(next_register, proto->arity);
+
+    for (auto &in : code) {
+        ForEachRegister(in, [&](uint16_t &reg, bool) { reg = assignment[reg]; });
+    }
+
+    // Drop moves whose source and destination were coalesced, remapping jump
+    // targets to the next surviving instruction.
+    std::vector<uint16_t> new_index(code.size() + 1);
+    std::vector<RegInstruction> compacted;
+    for (size_t i = 0; i < code.size(); ++i) {
+        new_index[i] = static_cast<uint16_t>(compacted.size());
+        const RegInstruction &in = code[i];
+        if (in.op == RegOpCode::MOVE && in.a == in.b)
+            continue;
+        compacted.push_back(in);
+    }
+    new_index[code.size()] = static_cast<uint16_t>(compacted.size());
+    for (auto &in : compacted) {
+        if (IsJump(in.op))
+            in.a = new_index[in.a];
+    }
+    code = std::move(compacted);
+}
+
+} // namespace suplang
@@ -0,0 +1,144 @@
+#include "VM/RegisterBytecode.h"
+
+#include <iomanip>
+
+namespace suplang {
+
+namespace {
+
+const char *OpName(RegOpCode op) {
+    switch (op) {
+    case RegOpCode::MOVE:
+        return "MOVE";
+    case RegOpCode::GET_GLOBAL:
+        return "GET_GLOBAL";
+    case RegOpCode::SET_GLOBAL:
+        return "SET_GLOBAL";
+    case RegOpCode::ADD:
+        return "ADD";
+    case RegOpCode::SUBTRACT:
+        return "SUBTRACT";
+    case RegOpCode::MULTIPLY:
+        return "MULTIPLY";
+    case RegOpCode::DIVIDE:
+        return "DIVIDE";
+    case RegOpCode::LESS:
+        return "LESS";
+    case RegOpCode::GREATER:
+        return "GREATER";
+    case RegOpCode::EQUAL:
+        return "EQUAL";
+    case RegOpCode::NOT_EQUAL:
+        return "NOT_EQUAL";
+    case RegOpCode::NEGATE:
+        return "NEGATE";
+    case RegOpCode::JUMP:
+        return "JUMP";
+    case RegOpCode::JUMP_IF_FALSE:
+        return "JUMP_IF_FALSE";
+    case RegOpCode::JUMP_UNLESS_LESS:
+        return "JUMP_UNLESS_LESS";
+    case RegOpCode::JUMP_UNLESS_GREATER:
+        return "JUMP_UNLESS_GREATER";
+    case RegOpCode::JUMP_UNLESS_EQUAL:
+        return "JUMP_UNLESS_EQUAL";
+    case RegOpCode::JUMP_UNLESS_NOT_EQUAL:
+        return "JUMP_UNLESS_NOT_EQUAL";
+    case RegOpCode::CALL:
+        return "CALL";
+    case RegOpCode::TAIL_CALL:
+        return "TAIL_CALL";
+    case RegOpCode::ARG:
+        return "ARG";
+    case RegOpCode::RETURN:
+        return "RETURN";
+    }
+    return "UNKNOWN";
+}
+
+// Formats an RK operand as `rN` for registers or the constant's value.
+void PrintOperand(const RegisterProto &proto, uint16_t operand, std::ostream &out) {
+    if (!(operand & kConstantBit)) {
+        out << "r" << operand;
+        return;
+    }
+    const Value &constant = proto.constants[operand & ~kConstantBit];
+    if (constant.isNil()) {
+        out << "nil";
+    } else if (constant.isInteger()) {
+        out << constant.asInteger();
+    } else if (constant.isBoolean()) {
+        out << (constant.asBoolean() ? "true" : "false");
+    } else {
+        out << "k" << (operand & ~kConstantBit);
+    }
+}
+
+} // namespace
+
+void Disassemble(const RegisterProto &proto, std::ostream &out) {
+    out << "== " << proto.name << " (arity " << proto.arity << ", registers " << proto.num_registers << ") ==\n";
+    for (size_t i = 0; i < proto.code.size(); ++i) {
+        const RegInstruction &in = proto.code[i];
+        out << std::setw(4) << std::setfill('0') << i << std::setfill(' ') << "  " << OpName(in.op);
+        switch (in.op) {
+        case RegOpCode::GET_GLOBAL:
+            out << " r" << in.a << " g" << in.b;
+            break;
+        case RegOpCode::SET_GLOBAL:
+            out << " g" << in.b << " ";
+            PrintOperand(proto, in.a, out);
+            break;
+        case RegOpCode::JUMP:
+            out << " -> " << in.a;
+            break;
+        case RegOpCode::JUMP_IF_FALSE:
+            out << " ";
+            PrintOperand(proto, in.b, out);
+            out << " -> " << in.a;
+            break;
+        case RegOpCode::JUMP_UNLESS_LESS:
+        case RegOpCode::JUMP_UNLESS_GREATER:
+        case RegOpCode::JUMP_UNLESS_EQUAL:
+        case RegOpCode::JUMP_UNLESS_NOT_EQUAL:
+            out << " ";
+            PrintOperand(proto, in.b, out);
+            out << " ";
+            PrintOperand(proto, in.c, out);
+            out << " -> " << in.a;
+            break;
+        case RegOpCode::CALL:
+        case RegOpCode::TAIL_CALL:
+            out << " r" << in.a << " ";
+            PrintOperand(proto, in.b, out);
+            out << " argc " << in.c;
+            break;
+        case RegOpCode::ARG:
+        case RegOpCode::RETURN:
+            out << " ";
+            PrintOperand(proto, in.a, out);
+            break;
+        case RegOpCode::MOVE:
+        case RegOpCode::NEGATE:
+            out << " r" << in.a << " ";
+            PrintOperand(proto, in.b, out);
+            break;
+        default:
+            out << " r" << in.a << " ";
+            PrintOperand(proto, in.b, out);
+            out << " ";
+            PrintOperand(proto, in.c, out);
+            break;
+        }
+        out << "\n";
+    }
+
+    for (const Value &constant : proto.constants) {
+        if (constant.isObject() && constant.asObject()->type == ObjectType::REGISTER_FUNCTION) {
+            out << "\n";
+            Disassemble(*static_cast<RegisterFunctionObject *>(constant.asObject())->proto, out);
+        }
+    }
+}
+
+} // namespace suplang
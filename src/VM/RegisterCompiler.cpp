@@ -0,0 +1,422 @@
+#include "VM/RegisterCompiler.h"
+
+#include "VM/Locals.h"
+#include "VM/RegisterAllocator.h"
+
+#include <iostream>
+
+namespace suplang {
+
+namespace {
+
+// Returns true if evaluating `node` may assign to a variable. Nested function
+// literals are not entered: their assignments target another frame.
+bool ContainsAssignment(ASTNode *node) {
+    if (!node)
+        return false;
+    if (auto ie = NodeCast<InfixExpressionNode>(node)) {
+        return ie->op == Operator::ASSIGN || ContainsAssignment(ie->left) || ContainsAssignment(ie->right);
+    }
+    if (auto pe = NodeCast<PrefixExpressionNode>(node)) {
+        return ContainsAssignment(pe->right);
+    }
+    if (auto ce = NodeCast<CallExpressionNode>(node)) {
+        if (ContainsAssignment(ce->function))
+            return true;
+        for (const auto &arg : ce->arguments) {
+            if (ContainsAssignment(arg))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool ArithmeticOpCode(Operator op, RegOpCode *code) {
+    switch (op) {
+    case Operator::ADD:
+        *code = RegOpCode::ADD;
+        return true;
+    case Operator::SUBTRACT:
+        *code = RegOpCode::SUBTRACT;
+        return true;
+    case Operator::MULTIPLY:
+        *code = RegOpCode::MULTIPLY;
+        return true;
+    case Operator::DIVIDE:
+        *code = RegOpCode::DIVIDE;
+        return true;
+    case Operator::LESS:
+        *code = RegOpCode::LESS;
+        return true;
+    case Operator::GREATER:
+        *code = RegOpCode::GREATER;
+        return true;
+    case Operator::EQUAL:
+        *code = RegOpCode::EQUAL;
+        return true;
+    case Operator::NOT_EQUAL:
+        *code = RegOpCode::NOT_EQUAL;
+        return true;
+    case Operator::ASSIGN:
+        break;
+    }
+    return false;
+}
+
+bool BranchOpCode(Operator op, RegOpCode *code) {
+    switch (op) {
+    case Operator::LESS:
+        *code = RegOpCode::JUMP_UNLESS_LESS;
+        return true;
+    case Operator::GREATER:
+        *code = RegOpCode::JUMP_UNLESS_GREATER;
+        return true;
+    case Operator::EQUAL:
+        *code = RegOpCode::JUMP_UNLESS_EQUAL;
+        return true;
+    case Operator::NOT_EQUAL:
+        *code = RegOpCode::JUMP_UNLESS_NOT_EQUAL;
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+RegisterProgram RegisterCompiler::compile(ProgramNode *program) {
+    auto script = std::make_shared<RegisterProto>();
+    script->name = "<script>";
+
+    FunctionState state;
+    state.proto = script.get();
+    state_ = &state;
+
+    uint16_t result = newRegister();
+    compileBlock(program->statements, result);
+    emit(RegOpCode::RETURN, result);
+    AllocateRegisters(script.get(), state.num_registers);
+
+    state_ = nullptr;
+    return {script, global_names_};
+}
+
+void RegisterCompiler::compileBlock(const ArenaArray<StatementNode *> &statements, int dst) {
+    if (statements.empty()) {
+        if (dst != kNoRegister)
+            emit(RegOpCode::MOVE, dst, nilConstant());
+        return;
+    }
+    // Only the last statement of a block can provide its completion value.
+    for (size_t i = 0; i + 1 < statements.size(); ++i) {
+        compileStatement(statements[i], kNoRegister);
+    }
+    compileStatement(statements.back(), dst);
+}
+
+void RegisterCompiler::compileStatement(StatementNode *node, int dst) {
+    if (auto es = NodeCast<ExpressionStatementNode>(node)) {
+        if (dst != kNoRegister) {
+            compileInto(es->expression, dst);
+        } else {
+            compileExpression(es->expression, kNoRegister);
+        }
+    } else if (auto vd = NodeCast<VarDeclNode>(node)) {
+        int local = localRegister(vd->varName);
+        if (local != kNoRegister) {
+            compileInto(vd->initialValue, local);
+            if (dst != kNoRegister)
+                emit(RegOpCode::MOVE, dst, local);
+        } else {
+            uint16_t value = compileExpression(vd->initialValue, dst);
+            emit(RegOpCode::SET_GLOBAL, value, globalSlot(vd->varName));
+            if (dst != kNoRegister && value != dst)
+                emit(RegOpCode::MOVE, dst, value);
+        }
+    } else if (auto rs = NodeCast<ReturnStatementNode>(node)) {
+        // `return f(...)` reuses the frame, so that deep tail recursion runs
+        // in constant space as in the interpreter. A callee that is not a
+        // function leaves null in the call's register for the RETURN.
+        if (auto call = NodeCast<CallExpressionNode>(rs->return_value)) {
+            emit(RegOpCode::RETURN, compileCallExpression(call, kNoRegister, RegOpCode::TAIL_CALL));
+        } else {
+            emit(RegOpCode::RETURN, compileExpression(rs->return_value, kNoRegister));
+        }
+    } else if (auto is = NodeCast<IfStatementNode>(node)) {
+        compileIfStatement(is, dst);
+    } else if (auto ws = NodeCast<WhileStatementNode>(node)) {
+        compileWhileStatement(ws, dst);
+    } else if (auto bs = NodeCast<BlockStatementNode>(node)) {
+        compileBlock(bs->statements, dst);
+    } else if (dst != kNoRegister) {
+        emit(RegOpCode::MOVE, dst, nilConstant());
+    }
+}
+
+void RegisterCompiler::compileIfStatement(IfStatementNode *node, int dst) {
+    size_t else_jump = compileConditionJump(node->condition);
+    compileBlock(node->consequence->statements, dst);
+    if (!node->alternative && dst == kNoRegister) {
+        patchJump(else_jump);
+        return;
+    }
+
+    size_t end_jump = emit(RegOpCode::JUMP);
+    patchJump(else_jump);
+    if (node->alternative) {
+        compileStatement(node->alternative, dst);
+    } else {
+        emit(RegOpCode::MOVE, dst, nilConstant());
+    }
+    patchJump(end_jump);
+}
+
+void RegisterCompiler::compileWhileStatement(WhileStatementNode *node, int dst) {
+    // The completion value of a loop is that of its last executed iteration.
+    if (dst != kNoRegister)
+        emit(RegOpCode::MOVE, dst, nilConstant());
+
+    size_t loop_start = state_->proto->code.size();
+    size_t exit_jump = compileConditionJump(node->condition);
+    compileBlock(node->body->statements, dst);
+    emit(RegOpCode::JUMP, static_cast<uint16_t>(loop_start));
+    patchJump(exit_jump);
+}
+
+size_t RegisterCompiler::compileConditionJump(ExpressionNode *condition) {
+    auto ie = NodeCast<InfixExpressionNode>(condition);
+    RegOpCode branch;
+    if (ie && BranchOpCode(ie->op, &branch)) {
+        uint16_t left = compileExpression(ie->left, kNoRegister);
+        left = protectOperand(left, ContainsAssignment(ie->right));
+        uint16_t right = compileExpression(ie->right, kNoRegister);
+        return emit(branch, 0, left, right);
+    }
+    return emit(RegOpCode::JUMP_IF_FALSE, 0, compileExpression(condition, kNoRegister));
+}
+
+void RegisterCompiler::compileInto(ExpressionNode *node, uint16_t dst) {
+    uint16_t value = compileExpression(node, dst);
+    if (value != dst)
+        emit(RegOpCode::MOVE, dst, value);
+}
+
+uint16_t RegisterCompiler::compileExpression(ExpressionNode *node, int dst) {
+    if (!node)
+        return nilConstant();
+    if (auto nl = NodeCast<NumberLiteralNode>(node))
+        return integerConstant(nl->value);
+    if (auto bl = NodeCast<BooleanLiteralNode>(node))
+        return booleanConstant(bl->value);
+    if (auto id = NodeCast<IdentifierNode>(node)) {
+        // Locals already live in a register, so reading one costs nothing.
+        int local = localRegister(id->symbol);
+        if (local != kNoRegister)
+            return static_cast<uint16_t>(local);
+        uint16_t target = dst != kNoRegister ? dst : newRegister();
+        emit(RegOpCode::GET_GLOBAL, target, globalSlot(id->symbol));
+        return target;
+    }
+    if (auto ie = NodeCast<InfixExpressionNode>(node))
+        return compileInfixExpression(ie, dst);
+    if (auto pe = NodeCast<PrefixExpressionNode>(node)) {
+        uint16_t operand = compileExpression(pe->right, kNoRegister);
+        if (pe->op != Operator::SUBTRACT)
+            return nilConstant();
+        uint16_t target = dst != kNoRegister ? dst : newRegister();
+        emit(RegOpCode::NEGATE, target, operand);
+        return target;
+    }
+    if (auto fl = NodeCast<FunctionLiteralNode>(node))
+        return compileFunctionLiteral(fl);
+    if (auto ce = NodeCast<CallExpressionNode>(node))
+        return compileCallExpression(ce, dst);
+    return nilConstant();
+}
+
+uint16_t RegisterCompiler::compileInfixExpression(InfixExpressionNode *node, int dst) {
+    if (node->op == Operator::ASSIGN) {
+        if (auto id = NodeCast<IdentifierNode>(node->left)) {
+            int local = localRegister(id->symbol);
+            if (local != kNoRegister) {
+                compileInto(node->right, local);
+                return static_cast<uint16_t>(local);
+            }
+            uint16_t value = compileExpression(node->right, dst);
+            emit(RegOpCode::SET_GLOBAL, value, globalSlot(id->symbol));
+            return value;
+        }
+    }
+
+    RegOpCode op;
+    if (!ArithmeticOpCode(node->op, &op)) {
+        // Assignment to something other than a name evaluates both operands
+        // and produces null.
+        compileExpression(node->left, kNoRegister);
+        compileExpression(node->right, kNoRegister);
+        return nilConstant();
+    }
+
+    uint16_t left = compileExpression(node->left, kNoRegister);
+    left = protectOperand(left, ContainsAssignment(node->right));
+    uint16_t right = compileExpression(node->right, kNoRegister);
+    uint16_t target = dst != kNoRegister ? dst : newRegister();
+    emit(op, target, left, right);
+    return target;
+}
+
+uint16_t RegisterCompiler::compileCallExpression(CallExpressionNode *node, int dst, RegOpCode op) {
+    // later_assigns[i] tells whether argument i or any after it may assign.
+    const auto &args = node->arguments;
+    std::vector<bool> later_assigns(args.size() + 1, false);
+    for (size_t i = args.size(); i-- > 0;) {
+        later_assigns[i] = later_assigns[i + 1] || ContainsAssignment(args[i]);
+    }
+
+    uint16_t function = compileExpression(node->function, kNoRegister);
+    function = protectOperand(function, later_assigns[0]);
+    std::vector<uint16_t> operands;
+    for (size_t i = 0; i < args.size(); ++i) {
+        uint16_t operand = compileExpression(args[i], kNoRegister);
+        operands.push_back(protectOperand(operand, later_assigns[i + 1]));
+    }
+
+    uint16_t target = dst != kNoRegister ? dst : newRegister();
+    emit(op, target, function, static_cast<uint16_t>(operands.size()));
+    for (uint16_t operand : operands) {
+        emit(RegOpCode::ARG, operand);
+    }
+    return target;
+}
+
+uint16_t RegisterCompiler::compileFunctionLiteral(FunctionLiteralNode *node) {
+    auto proto = std::make_shared<RegisterProto>();
+    proto->name = "<fn>";
+    proto->arity = node->parameters.size();
+    // Captured variables would need cells and upvalues, which the VM lacks;
+    // compiled as globals they would silently read the wrong variable.
+    if (!node->upvalues.empty()) {
+        std::cerr << "Compiler Error at " << node->location.line << ":" << node->location.column
+                  << ": Closures capturing local variables need the ast, jit or closure backend.\n";
+        ++error_count_;
+    }
+
+    FunctionState state;
+    state.proto = proto.get();
+    FunctionState *enclosing = state_;
+    state_ = &state;
+
+    // Parameters take the first virtual registers; a repeated name binds to
+    // the last parameter, as it would in the interpreter.
+    for (const auto &param : node->parameters) {
+        state.locals[param.param_name] = static_cast<uint16_t>(state.num_locals++);
+    }
+    std::vector<Symbol> names;
+    CollectLocals(node->body, &names);
+    for (const auto &name : names) {
+        if (!state.locals.count(name))
+            state.locals[name] = static_cast<uint16_t>(state.num_locals++);
+    }
+    state.num_registers = state.num_locals;
+
+    uint16_t result = newRegister();
+    if (node->body) {
+        compileBlock(node->body->statements, result);
+    } else {
+        emit(RegOpCode::MOVE, result, nilConstant());
+    }
+    emit(RegOpCode::RETURN, result);
+    AllocateRegisters(proto.get(), state.num_registers);
+
+    state_ = enclosing;
+    auto function = std::make_unique<RegisterFunctionObject>(proto);
+    uint16_t constant = addConstant(Value::FromObject(function.get()));
+    state_->proto->objects.push_back(std::move(function));
+    return constant;
+}
+
+uint16_t RegisterCompiler::protectOperand(uint16_t operand, bool later_assigns) {
+    if (!later_assigns || !isLocalRegister(operand))
+        return operand;
+    uint16_t copy = newRegister();
+    emit(RegOpCode::MOVE, copy, operand);
+    return copy;
+}
+
+bool RegisterCompiler::isLocalRegister(uint16_t operand) const {
+    return !(operand & kConstantBit) && operand < state_->num_locals;
+}
+
+int RegisterCompiler::localRegister(Symbol name) const {
+    auto it = state_->locals.find(name);
+    return it != state_->locals.end() ? it->second : kNoRegister;
+}
+
+uint16_t RegisterCompiler::globalSlot(Symbol name) {
+    auto it = global_slots_.find(name);
+    if (it != global_slots_.end())
+        return it->second;
+    uint16_t slot = static_cast<uint16_t>(global_names_.size());
+    global_slots_[name] = slot;
+    global_names_.push_back(name);
+    return slot;
+}
+
+uint16_t RegisterCompiler::newRegister() {
+    if (state_->num_registers >= kConstantBit) {
+        std::cerr << "Compiler Error: Too many registers in one function.\n";
+        ++error_count_;
+        return 0;
+    }
+    return static_cast<uint16_t>(state_->num_registers++);
+}
+
+uint16_t RegisterCompiler::integerConstant(int32_t value) {
+    auto it = state_->integer_constants.find(value);
+    if (it != state_->integer_constants.end())
+        return it->second;
+    uint16_t operand = addConstant(Value::Integer(value));
+    state_->integer_constants[value] = operand;
+    return operand;
+}
+
+uint16_t RegisterCompiler::booleanConstant(bool value) {
+    int &cached = state_->bool_constants[value ? 1 : 0];
+    if (cached < 0)
+        cached = addConstant(Value::Boolean(value));
+    return static_cast<uint16_t>(cached);
+}
+
+uint16_t RegisterCompiler::nilConstant() {
+    if (state_->nil_constant < 0)
+        state_->nil_constant = addConstant(Value());
+    return static_cast<uint16_t>(state_->nil_constant);
+}
+
+uint16_t RegisterCompiler::addConstant(Value value) {
+    auto &constants = state_->proto->constants;
+    if (constants.size() >= kConstantBit) {
+        std::cerr << "Compiler Error: Too many constants in one function.\n";
+        ++error_count_;
+        return kConstantBit;
+    }
+    constants.push_back(std::move(value));
+    return static_cast<uint16_t>((constants.size() - 1) | kConstantBit);
+}
+
+size_t RegisterCompiler::emit(RegOpCode op, uint16_t a, uint16_t b, uint16_t c) {
+    state_->proto->code.push_back({op, a, b, c});
+    return state_->proto->code.size() - 1;
+}
+
+// Points the jump at `index` to the next instruction to be emitted.
+void RegisterCompiler::patchJump(size_t index) {
+    auto &code = state_->proto->code;
+    if (code.size() > 0xffff) {
+        std::cerr << "Compiler Error: Function too large for 16-bit jump targets.\n";
+        ++error_count_;
+    }
+    code[index].a = static_cast<uint16_t>(code.size());
+}
+
+} // namespace suplang
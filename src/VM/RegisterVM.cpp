@@ -0,0 +1,250 @@
+#include "VM/RegisterVM.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace suplang {
+
+namespace {
+
+// Maximum call depth before the VM reports a stack overflow.
+constexpr size_t kMaxFrames = 1 << 14;
+
+bool BothIntegers(const Value &left, const Value &right) { return left.isInteger() && right.isInteger(); }
+
+} // namespace
+
+Value RegisterVM::run(const RegisterProgram &program) {
+    program_ = &program;
+    globals_.assign(program.global_names.size(), Value());
+    frames_.clear();
+    instruction_count_ = 0;
+
+    const RegisterProto *script = program.script.get();
+    registers_.assign(std::max<size_t>(script->num_registers, 256), Value());
+    frames_.push_back({script, script->code.data(), 0, 0});
+    return execute();
+}
+
+Value RegisterVM::getGlobal(const std::string &name) const {
+    if (!program_)
+        return Value();
+    Symbol symbol = SymbolTable::Global().find(name);
+    for (size_t i = 0; i < program_->global_names.size(); ++i) {
+        if (program_->global_names[i] == symbol)
+            return globals_[i];
+    }
+    return Value();
+}
+
+// The main dispatch loop. `R` points at register 0 of the active frame and
+// `K` at its constant pool; both are refreshed whenever the frame changes.
+Value RegisterVM::execute() {
+    CallFrame *frame = &frames_.back();
+    const RegInstruction *pc = frame->pc;
+    Value *R = &registers_[frame->base];
+    const Value *K = frame->proto->constants.data();
+
+    auto rk = [&](uint16_t operand) -> const Value & {
+        return (operand & kConstantBit) ? K[operand & ~kConstantBit] : R[operand];
+    };
+
+    for (;;) {
+        const RegInstruction &in = *pc++;
+        ++instruction_count_;
+        switch (in.op) {
+        case RegOpCode::MOVE:
+            R[in.a] = rk(in.b);
+            break;
+        case RegOpCode::GET_GLOBAL:
+            R[in.a] = globals_[in.b];
+            break;
+        case RegOpCode::SET_GLOBAL:
+            globals_[in.b] = rk(in.a);
+            break;
+
+        case RegOpCode::ADD:
+        case RegOpCode::SUBTRACT:
+        case RegOpCode::MULTIPLY:
+        case RegOpCode::DIVIDE:
+        case RegOpCode::LESS:
+        case RegOpCode::GREATER:
+        case RegOpCode::EQUAL:
+        case RegOpCode::NOT_EQUAL: {
+            const auto &left = rk(in.b);
+            const auto &right = rk(in.c);
+            // As in the interpreter, operators are only defined on integers.
+            if (!BothIntegers(left, right)) {
+                R[in.a] = Value();
+                break;
+            }
+            int32_t left_val = left.asInteger();
+            int32_t right_val = right.asInteger();
+            switch (in.op) {
+            case RegOpCode::ADD:
+                R[in.a] = Value::Integer(Wrap(static_cast<uint32_t>(left_val) + static_cast<uint32_t>(right_val)));
+                break;
+            case RegOpCode::SUBTRACT:
+                R[in.a] = Value::Integer(Wrap(static_cast<uint32_t>(left_val) - static_cast<uint32_t>(right_val)));
+                break;
+            case RegOpCode::MULTIPLY:
+                R[in.a] = Value::Integer(Wrap(static_cast<uint32_t>(left_val) * static_cast<uint32_t>(right_val)));
+                break;
+            case RegOpCode::DIVIDE:
+                R[in.a] = Value::Integer(Divide(left_val, right_val));
+                break;
+            case RegOpCode::LESS:
+                R[in.a] = Value::Boolean(left_val < right_val);
+                break;
+            case RegOpCode::GREATER:
+                R[in.a] = Value::Boolean(left_val > right_val);
+                break;
+            case RegOpCode::EQUAL:
+                R[in.a] = Value::Boolean(left_val == right_val);
+                break;
+            default:
+                R[in.a] = Value::Boolean(left_val != right_val);
+                break;
+            }
+            break;
+        }
+        case RegOpCode::NEGATE: {
+            const auto &operand = rk(in.b);
+            R[in.a] =
+                operand.isInteger() ? Value::Integer(Wrap(0u - static_cast<uint32_t>(operand.asInteger()))) : Value();
+            break;
+        }
+
+        case RegOpCode::JUMP:
+            pc = frame->proto->code.data() + in.a;
+            break;
+        case RegOpCode::JUMP_IF_FALSE:
+            if (!rk(in.b).isTruthy())
+                pc = frame->proto->code.data() + in.a;
+            break;
+        case RegOpCode::JUMP_UNLESS_LESS:
+        case RegOpCode::JUMP_UNLESS_GREATER:
+        case RegOpCode::JUMP_UNLESS_EQUAL:
+        case RegOpCode::JUMP_UNLESS_NOT_EQUAL: {
+            const auto &left = rk(in.b);
+            const auto &right = rk(in.c);
+            // A comparison of non-integers yields null, which is falsy.
+            bool holds = false;
+            if (BothIntegers(left, right)) {
+                int32_t left_val = left.asInteger();
+                int32_t right_val = right.asInteger();
+                switch (in.op) {
+                case RegOpCode::JUMP_UNLESS_LESS:
+                    holds = left_val < right_val;
+                    break;
+                case RegOpCode::JUMP_UNLESS_GREATER:
+                    holds = left_val > right_val;
+                    break;
+                case RegOpCode::JUMP_UNLESS_EQUAL:
+                    holds = left_val == right_val;
+                    break;
+                default:
+                    holds = left_val != right_val;
+                    break;
+                }
+            }
+            if (!holds)
+                pc = frame->proto->code.data() + in.a;
+            break;
+        }
+
+        case RegOpCode::CALL: {
+            // The arguments are encoded as ARG instructions after the call.
+            const RegInstruction *args = pc;
+            size_t argc = in.c;
+            pc += argc;
+
+            const auto &callee = rk(in.b);
+            if (!callee.isObject() || callee.asObject()->type != ObjectType::REGISTER_FUNCTION) {
+                // Calling a non-function evaluates to null.
+                R[in.a] = Value();
+                break;
+            }
+            if (frames_.size() >= kMaxFrames) {
+                std::cerr << "Runtime Error: Stack overflow.\n";
+                return Value();
+            }
+            const RegisterProto *proto = static_cast<RegisterFunctionObject *>(callee.asObject())->proto.get();
+
+            size_t base = frame->base + frame->proto->num_registers;
+            if (registers_.size() < base + proto->num_registers) {
+                registers_.resize(std::max(registers_.size() * 2, base + proto->num_registers));
+                R = &registers_[frame->base];
+            }
+            // Surplus arguments are dropped; missing ones and the remaining
+            // registers start out null.
+            Value *callee_registers = &registers_[base];
+            size_t bound = std::min(argc, proto->arity);
+            for (size_t i = 0; i < bound; ++i) {
+                callee_registers[i] = rk(args[i].a);
+            }
+            for (size_t i = bound; i < proto->num_registers; ++i) {
+                callee_registers[i] = Value();
+            }
+
+            frame->pc = pc;
+            frames_.push_back({proto, proto->code.data(), base, in.a});
+            frame = &frames_.back();
+            pc = frame->pc;
+            R = callee_registers;
+            K = proto->constants.data();
+            break;
+        }
+        case RegOpCode::TAIL_CALL: {
+            const RegInstruction *args = pc;
+            size_t argc = in.c;
+            pc += argc;
+
+            const auto &callee = rk(in.b);
+            if (!callee.isObject() || callee.asObject()->type != ObjectType::REGISTER_FUNCTION) {
+                R[in.a] = Value();
+                break;
+            }
+            const RegisterProto *proto = static_cast<RegisterFunctionObject *>(callee.asObject())->proto.get();
+
+            // The arguments may be in the registers they are about to replace.
+            size_t bound = std::min(argc, proto->arity);
+            tail_arguments_.clear();
+            for (size_t i = 0; i < bound; ++i) {
+                tail_arguments_.push_back(rk(args[i].a));
+            }
+            if (registers_.size() < frame->base + proto->num_registers)
+                registers_.resize(std::max(registers_.size() * 2, frame->base + proto->num_registers));
+            R = &registers_[frame->base];
+            std::move(tail_arguments_.begin(), tail_arguments_.end(), R);
+            for (size_t i = bound; i < proto->num_registers; ++i) {
+                R[i] = Value();
+            }
+
+            // The callee runs in the current frame and returns to its caller.
+            frame->proto = proto;
+            pc = proto->code.data();
+            K = proto->constants.data();
+            break;
+        }
+        case RegOpCode::ARG:
+            // Consumed by CALL and TAIL_CALL; never dispatched.
+            break;
+        case RegOpCode::RETURN: {
+            Value result = rk(in.a);
+            uint16_t return_reg = frame->return_reg;
+            frames_.pop_back();
+            if (frames_.empty())
+                return result;
+            frame = &frames_.back();
+            pc = frame->pc;
+            R = &registers_[frame->base];
+            K = frame->proto->constants.data();
+            R[return_reg] = std::move(result);
+            break;
+        }
+        }
+    }
+}
+
+} // namespace suplang
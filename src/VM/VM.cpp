@@ -0,0 +1,227 @@
+#include "VM/VM.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace suplang {
+
+namespace {
+
+// Maximum call depth before the VM reports a stack overflow.
+constexpr size_t kMaxFrames = 1 << 14;
+
+uint16_t ReadOperand(const uint8_t *&ip) {
+    uint16_t operand = static_cast<uint16_t>(ip[0] | (ip[1] << 8));
+    ip += 2;
+    return operand;
+}
+
+} // namespace
+
+Value VM::run(const CompiledProgram &program) {
+    program_ = &program;
+    globals_.assign(program.global_names.size(), Value());
+    stack_.clear();
+    frames_.clear();
+    instruction_count_ = 0;
+
+    const FunctionProto *script = program.script.get();
+    stack_.resize(script->num_locals);
+    frames_.push_back({script, script->chunk.code.data(), 0});
+    return execute();
+}
+
+Value VM::getGlobal(const std::string &name) const {
+    if (!program_)
+        return Value();
+    Symbol symbol = SymbolTable::Global().find(name);
+    for (size_t i = 0; i < program_->global_names.size(); ++i) {
+        if (program_->global_names[i] == symbol)
+            return globals_[i];
+    }
+    return Value();
+}
+
+// The main dispatch loop. The instruction pointer of the active frame is kept
+// in a local and written back to the frame only around calls.
+Value VM::execute() {
+    CallFrame *frame = &frames_.back();
+    const uint8_t *ip = frame->ip;
+    const std::vector<Value> *constants = &frame->proto->chunk.constants;
+
+    auto pop = [this]() {
+        Value value = std::move(stack_.back());
+        stack_.pop_back();
+        return value;
+    };
+
+    for (;;) {
+        ++instruction_count_;
+        switch (static_cast<OpCode>(*ip++)) {
+        case OpCode::CONSTANT:
+            stack_.push_back((*constants)[ReadOperand(ip)]);
+            break;
+        case OpCode::NIL:
+            stack_.push_back(Value());
+            break;
+        case OpCode::TRUE:
+            stack_.push_back(Value::Boolean(true));
+            break;
+        case OpCode::FALSE:
+            stack_.push_back(Value::Boolean(false));
+            break;
+        case OpCode::POP:
+            stack_.pop_back();
+            break;
+        case OpCode::GET_LOCAL:
+            stack_.push_back(stack_[frame->base + ReadOperand(ip)]);
+            break;
+        case OpCode::SET_LOCAL:
+            stack_[frame->base + ReadOperand(ip)] = stack_.back();
+            break;
+        case OpCode::GET_GLOBAL:
+            stack_.push_back(globals_[ReadOperand(ip)]);
+            break;
+        case OpCode::SET_GLOBAL:
+            globals_[ReadOperand(ip)] = stack_.back();
+            break;
+
+        case OpCode::ADD:
+        case OpCode::SUBTRACT:
+        case OpCode::MULTIPLY:
+        case OpCode::DIVIDE:
+        case OpCode::LESS:
+        case OpCode::GREATER:
+        case OpCode::EQUAL:
+        case OpCode::NOT_EQUAL: {
+            auto op = static_cast<OpCode>(ip[-1]);
+            auto right = pop();
+            auto left = pop();
+            // As in the interpreter, operators are only defined on integers.
+            if (!left.isInteger() || !right.isInteger()) {
+                stack_.push_back(Value());
+                break;
+            }
+            int32_t left_val = left.asInteger();
+            int32_t right_val = right.asInteger();
+            switch (op) {
+            case OpCode::ADD:
+                stack_.push_back(
+                    Value::Integer(Wrap(static_cast<uint32_t>(left_val) + static_cast<uint32_t>(right_val))));
+                break;
+            case OpCode::SUBTRACT:
+                stack_.push_back(
+                    Value::Integer(Wrap(static_cast<uint32_t>(left_val) - static_cast<uint32_t>(right_val))));
+                break;
+            case OpCode::MULTIPLY:
+                stack_.push_back(
+                    Value::Integer(Wrap(static_cast<uint32_t>(left_val) * static_cast<uint32_t>(right_val))));
+                break;
+            case OpCode::DIVIDE:
+                stack_.push_back(Value::Integer(Divide(left_val, right_val)));
+                break;
+            case OpCode::LESS:
+                stack_.push_back(Value::Boolean(left_val < right_val));
+                break;
+            case OpCode::GREATER:
+                stack_.push_back(Value::Boolean(left_val > right_val));
+                break;
+            case OpCode::EQUAL:
+                stack_.push_back(Value::Boolean(left_val == right_val));
+                break;
+            default:
+                stack_.push_back(Value::Boolean(left_val != right_val));
+                break;
+            }
+            break;
+        }
+        case OpCode::NEGATE: {
+            auto &top = stack_.back();
+            top = top.isInteger() ? Value::Integer(Wrap(0u - static_cast<uint32_t>(top.asInteger()))) : Value();
+            break;
+        }
+
+        case OpCode::JUMP: {
+            uint16_t offset = ReadOperand(ip);
+            ip += offset;
+            break;
+        }
+        case OpCode::JUMP_IF_FALSE: {
+            uint16_t offset = ReadOperand(ip);
+            if (!pop().isTruthy())
+                ip += offset;
+            break;
+        }
+        case OpCode::LOOP: {
+            uint16_t offset = ReadOperand(ip);
+            ip -= offset;
+            break;
+        }
+
+        case OpCode::CALL: {
+            size_t argc = ReadOperand(ip);
+            size_t base = stack_.size() - argc;
+            const auto &callee = stack_[base - 1];
+            if (!callee.isObject() || callee.asObject()->type != ObjectType::COMPILED_FUNCTION) {
+                // Calling a non-function evaluates to null.
+                stack_.resize(base - 1);
+                stack_.push_back(Value());
+                break;
+            }
+            if (frames_.size() >= kMaxFrames) {
+                std::cerr << "Runtime Error: Stack overflow.\n";
+                return Value();
+            }
+            const FunctionProto *proto = static_cast<CompiledFunctionObject *>(callee.asObject())->proto.get();
+            // Surplus arguments are dropped; missing ones and the remaining
+            // locals start out null.
+            stack_.resize(base + std::min(argc, proto->arity));
+            stack_.resize(base + proto->num_locals);
+
+            frame->ip = ip;
+            frames_.push_back({proto, proto->chunk.code.data(), base});
+            frame = &frames_.back();
+            ip = frame->ip;
+            constants = &proto->chunk.constants;
+            break;
+        }
+        case OpCode::TAIL_CALL: {
+            size_t argc = ReadOperand(ip);
+            size_t callee = stack_.size() - argc - 1;
+            if (!stack_[callee].isObject() || stack_[callee].asObject()->type != ObjectType::COMPILED_FUNCTION) {
+                stack_.resize(callee);
+                stack_.push_back(Value());
+                break;
+            }
+            const FunctionProto *proto = static_cast<CompiledFunctionObject *>(stack_[callee].asObject())->proto.get();
+            // The callee and its arguments replace those of the current call,
+            // whose frame then runs the callee from the start.
+            std::move(stack_.begin() + callee, stack_.end(), stack_.begin() + (frame->base - 1));
+            stack_.resize(frame->base + std::min(argc, proto->arity));
+            stack_.resize(frame->base + proto->num_locals);
+            frame->proto = proto;
+            ip = proto->chunk.code.data();
+            constants = &proto->chunk.constants;
+            break;
+        }
+        case OpCode::RETURN: {
+            auto result = pop();
+            if (frames_.size() == 1) {
+                frames_.pop_back();
+                stack_.clear();
+                return result;
+            }
+            // Discard the callee, its locals and any temporaries.
+            stack_.resize(frame->base - 1);
+            frames_.pop_back();
+            frame = &frames_.back();
+            ip = frame->ip;
+            constants = &frame->proto->chunk.constants;
+            stack_.push_back(std::move(result));
+            break;
+        }
+        }
+    }
+}
+
+} // namespace suplang
@@ -1,13 +1,30 @@
+#include <charconv>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
 
 #include "AST/ASTNode.h"
+#include "AST/NodeVisitor.h"
+#include "AST/TreeCache.h"
+#include "Interpreter/ClosureCompiler.h"
+#include "Interpreter/ClosureInterpreter.h"
 #include "Interpreter/Environment.h"
 #include "Interpreter/Interpreter.h"
+#include "Interpreter/LazyFunctions.h"
+#include "Interpreter/Profiler.h"
+#include "Interpreter/Resolver.h"
+#include "Interpreter/TypeChecker.h"
 #include "Lexer/Lexer.h"
+#include "Lexer/SourceBuffer.h"
+#include "Object/Heap.h"
 #include "Object/Object.h"
+#include "Optimizer/ConstantFolder.h"
 #include "Parser/Parser.h"
+#include "VM/Compiler.h"
+#include "VM/RegisterCompiler.h"
+#include "VM/RegisterVM.h"
+#include "VM/VM.h"
 
 namespace {
 // A utility function to recursively print the AST for debugging purposes.
@@ -19,74 +36,90 @@ void PrintAST(const suplang::ASTNode *node, int indent = 0) {
     // Use indentation to represent the tree structure.
     std::cout << std::string(indent * 2, ' ');
 
-    if (auto p = dynamic_cast<const suplang::ProgramNode *>(node)) {
-        std::cout << "[Program]\n";
-        for (const auto &stmt : p->statements) {
-            PrintAST(stmt.get(), indent + 1);
-        }
-    } else if (auto vd = dynamic_cast<const suplang::VarDeclNode *>(node)) {
-        std::cout << "[VarDecl] Type: " << vd->varType << ", Name: " << vd->varName << "\n";
-        PrintAST(vd->initialValue.get(), indent + 2);
-    } else if (auto es = dynamic_cast<const suplang::ExpressionStatementNode *>(node)) {
-        std::cout << "[ExprStmt]\n";
-        PrintAST(es->expression.get(), indent + 1);
-    } else if (auto rs = dynamic_cast<const suplang::ReturnStatementNode *>(node)) {
-        std::cout << "[ReturnStmt]\n";
-        PrintAST(rs->return_value.get(), indent + 1);
-    } else if (auto ws = dynamic_cast<const suplang::WhileStatementNode *>(node)) {
-        std::cout << "[WhileStmt]\n";
-        std::cout << std::string((indent + 1) * 2, ' ') << "[Condition]\n";
-        PrintAST(ws->condition.get(), indent + 2);
-        std::cout << std::string((indent + 1) * 2, ' ') << "[Body]\n";
-        PrintAST(ws->body.get(), indent + 2);
-    } else if (auto is = dynamic_cast<const suplang::IfStatementNode *>(node)) {
-        std::cout << "[IfStmt]\n";
-        std::cout << std::string((indent + 1) * 2, ' ') << "[Condition]\n";
-        PrintAST(is->condition.get(), indent + 2);
-        std::cout << std::string((indent + 1) * 2, ' ') << "[Consequence]\n";
-        PrintAST(is->consequence.get(), indent + 2);
-        if (is->alternative) {
-            std::cout << std::string((indent + 1) * 2, ' ') << "[Alternative]\n";
-            PrintAST(is->alternative.get(), indent + 2);
-        }
-    } else if (auto bs = dynamic_cast<const suplang::BlockStatementNode *>(node)) {
-        std::cout << "[BlockStmt]\n";
-        for (const auto &stmt : bs->statements) {
-            PrintAST(stmt.get(), indent + 1);
-        }
-    } else if (auto fl = dynamic_cast<const suplang::FunctionLiteralNode *>(node)) {
-        std::cout << "[FunctionLiteral]\n";
-        std::cout << std::string((indent + 1) * 2, ' ') << "[Parameters]\n";
-        for (const auto &param : fl->parameters) {
-            std::cout << std::string((indent + 2) * 2, ' ') << param.type_name << " " << param.param_name << "\n";
-        }
-        std::cout << std::string((indent + 1) * 2, ' ') << "[Body]\n";
-        PrintAST(fl->body.get(), indent + 2);
-    } else if (auto ce = dynamic_cast<const suplang::CallExpressionNode *>(node)) {
-        std::cout << "[CallExpr]\n";
-        std::cout << std::string((indent + 1) * 2, ' ') << "[Function]\n";
-        PrintAST(ce->function.get(), indent + 2);
-        std::cout << std::string((indent + 1) * 2, ' ') << "[Arguments]\n";
-        for (const auto &arg : ce->arguments) {
-            PrintAST(arg.get(), indent + 2);
-        }
-    } else if (auto ie = dynamic_cast<const suplang::InfixExpressionNode *>(node)) {
-        std::cout << "[InfixExpr] Op: " << ie->op << "\n";
-        PrintAST(ie->left.get(), indent + 1);
-        PrintAST(ie->right.get(), indent + 1);
-    } else if (auto id = dynamic_cast<const suplang::IdentifierNode *>(node)) {
-        std::cout << "[Identifier] " << id->value << "\n";
-    } else if (auto nl = dynamic_cast<const suplang::NumberLiteralNode *>(node)) {
-        std::cout << "[Number] " << nl->value << "\n";
-    } else if (auto bl = dynamic_cast<const suplang::BooleanLiteralNode *>(node)) {
-        std::cout << "[Boolean] " << (bl->value ? "true" : "false") << "\n";
-    }
+    // Indentation for the labels that introduce a node's children.
+    std::string pad((indent + 1) * 2, ' ');
+    suplang::VisitNode<void>(
+        node, suplang::Overloaded{
+                  [&](const suplang::ProgramNode *p) {
+                      std::cout << "[Program]\n";
+                      for (const auto &stmt : p->statements) {
+                          PrintAST(stmt, indent + 1);
+                      }
+                  },
+                  [&](const suplang::VarDeclNode *vd) {
+                      std::cout << "[VarDecl] Type: " << vd->varType << ", Name: " << suplang::SymbolName(vd->varName) << "\n";
+                      PrintAST(vd->initialValue, indent + 2);
+                  },
+                  [&](const suplang::ExpressionStatementNode *es) {
+                      std::cout << "[ExprStmt]\n";
+                      PrintAST(es->expression, indent + 1);
+                  },
+                  [&](const suplang::ReturnStatementNode *rs) {
+                      std::cout << "[ReturnStmt]\n";
+                      PrintAST(rs->return_value, indent + 1);
+                  },
+                  [&](const suplang::WhileStatementNode *ws) {
+                      std::cout << "[WhileStmt]\n";
+                      std::cout << pad << "[Condition]\n";
+                      PrintAST(ws->condition, indent + 2);
+                      std::cout << pad << "[Body]\n";
+                      PrintAST(ws->body, indent + 2);
+                  },
+                  [&](const suplang::IfStatementNode *is) {
+                      std::cout << "[IfStmt]\n";
+                      std::cout << pad << "[Condition]\n";
+                      PrintAST(is->condition, indent + 2);
+                      std::cout << pad << "[Consequence]\n";
+                      PrintAST(is->consequence, indent + 2);
+                      if (is->alternative) {
+                          std::cout << pad << "[Alternative]\n";
+                          PrintAST(is->alternative, indent + 2);
+                      }
+                  },
+                  [&](const suplang::BlockStatementNode *bs) {
+                      std::cout << "[BlockStmt]\n";
+                      for (const auto &stmt : bs->statements) {
+                          PrintAST(stmt, indent + 1);
+                      }
+                  },
+                  [&](const suplang::FunctionLiteralNode *fl) {
+                      std::cout << "[FunctionLiteral]\n";
+                      std::cout << pad << "[Parameters]\n";
+                      for (const auto &param : fl->parameters) {
+                          std::cout << std::string((indent + 2) * 2, ' ') << param.type_name << " " << suplang::SymbolName(param.param_name)
+                                    << "\n";
+                      }
+                      std::cout << pad << (fl->isDeferred() ? "[Body] (deferred)\n" : "[Body]\n");
+                      PrintAST(fl->body, indent + 2);
+                  },
+                  [&](const suplang::CallExpressionNode *ce) {
+                      std::cout << "[CallExpr]\n";
+                      std::cout << pad << "[Function]\n";
+                      PrintAST(ce->function, indent + 2);
+                      std::cout << pad << "[Arguments]\n";
+                      for (const auto &arg : ce->arguments) {
+                          PrintAST(arg, indent + 2);
+                      }
+                  },
+                  [&](const suplang::InfixExpressionNode *ie) {
+                      std::cout << "[InfixExpr] Op: " << suplang::OperatorSpelling(ie->op) << "\n";
+                      PrintAST(ie->left, indent + 1);
+                      PrintAST(ie->right, indent + 1);
+                  },
+                  [&](const suplang::PrefixExpressionNode *pe) {
+                      std::cout << "[PrefixExpr] Op: " << suplang::OperatorSpelling(pe->op) << "\n";
+                      PrintAST(pe->right, indent + 1);
+                  },
+                  [&](const suplang::IdentifierNode *id) { std::cout << "[Identifier] " << suplang::SymbolName(id->symbol) << "\n"; },
+                  [&](const suplang::NumberLiteralNode *nl) { std::cout << "[Number] " << nl->value << "\n"; },
+                  [&](const suplang::BooleanLiteralNode *bl) {
+                      std::cout << "[Boolean] " << (bl->value ? "true" : "false") << "\n";
+                  },
+              });
 }
-} // namespace
 
-int main() {
-    // The source code to be interpreted.
-    std::string code = R"(
+// The program run when no script file is given on the command line.
+const char *kDemoProgram = R"(
       int32 counter = 0;
       while (counter < 3) {
           counter = counter + 1;
@@ -94,34 +127,223 @@ int main() {
       int32 result = counter;
   )";
 
+// Reports on the collected heap of the ast or closure backend. The compiled
+// backends allocate nothing at run time, so they have no heap.
+void PrintHeapStats(const suplang::Heap &heap) {
+    std::cerr << "--- GC Statistics ---\n";
+    suplang::PrintGcStats(heap.stats(), heap.bytesAllocated(), std::cerr);
+    suplang::PrintSlabStats(suplang::SlabPool::Local().stats(), std::cerr);
+    std::cerr << "---------------------\n";
+}
+
+void PrintUsage(const char *argv0) {
+    std::cerr << "Usage: " << argv0 << " [--backend=ast|jit|closure|stack|register]\n"
+              << "       [--dump-ast] [--dump-optimized-ast] [--dump-bytecode] [--gc-stats] [--gc-threshold=BYTES]\n"
+              << "       [--gc-stress] [--lazy-parse] [--cache] [--profile=FILE] [script]\n"
+              << "With --lazy-parse, function bodies are parsed and type-checked on their first call: an error\n"
+              << "there stops the run, and a body never called is never checked.\n";
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string backend = "ast";
+    std::string script_path;
+    bool dump_ast = false;
+    bool dump_optimized_ast = false;
+    bool dump_bytecode = false;
+    bool gc_stats = false;
+    bool lazy_parse = false;
+    bool cache = false;
+    std::string profile_path;
+    suplang::GcOptions gc_options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--backend=", 0) == 0) {
+            backend = arg.substr(std::string("--backend=").size());
+        } else if (arg == "--dump-ast") {
+            dump_ast = true;
+        } else if (arg == "--dump-optimized-ast") {
+            dump_optimized_ast = true;
+        } else if (arg == "--dump-bytecode") {
+            dump_bytecode = true;
+        } else if (arg == "--gc-stats") {
+            gc_stats = true;
+        } else if (arg == "--lazy-parse") {
+            lazy_parse = true;
+        } else if (arg == "--cache") {
+            cache = true;
+        } else if (arg.rfind("--profile=", 0) == 0) {
+            profile_path = arg.substr(std::string("--profile=").size());
+        } else if (arg == "--gc-stress") {
+            gc_options.stress = true;
+        } else if (arg.rfind("--gc-threshold=", 0) == 0) {
+            const char *first = arg.data() + std::string("--gc-threshold=").size();
+            const char *last = arg.data() + arg.size();
+            auto [end, error] = std::from_chars(first, last, gc_options.initial_threshold);
+            if (error != std::errc() || end != last) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        } else if (!arg.empty() && arg[0] == '-') {
+            PrintUsage(argv[0]);
+            return 1;
+        } else {
+            script_path = arg;
+        }
+    }
+    if (backend != "ast" && backend != "jit" && backend != "closure" && backend != "stack" && backend != "register") {
+        std::cerr << "Unknown backend '" << backend << "'.\n";
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    // Only the tree-walking backends can run a function whose body is not
+    // parsed yet.
+    if (lazy_parse && backend != "ast" && backend != "jit") {
+        std::cerr << "--lazy-parse needs the ast or jit backend.\n";
+        return 1;
+    }
+    if (!profile_path.empty() && backend != "ast" && backend != "jit") {
+        std::cerr << "--profile needs the ast or jit backend.\n";
+        return 1;
+    }
+
+    // The source code to be interpreted. Script files are memory-mapped.
+    bool demo = script_path.empty();
+    auto source = demo ? suplang::SourceBuffer::FromString(kDemoProgram) : suplang::SourceBuffer::FromFile(script_path);
+    if (!source) {
+        std::cerr << "Could not read '" << script_path << "'.\n";
+        return 1;
+    }
+
+    // With --cache, a script's tree is kept beside it after parsing and
+    // constant folding, and later runs of the unchanged script start from
+    // it. Dumping the unfolded tree needs a real parse.
+    bool use_cache = cache && !demo && !dump_ast;
+    uint32_t cache_flags = suplang::kTreeFolded | (lazy_parse ? suplang::kTreeDeferredBodies : 0);
+    std::string cache_path = suplang::TreeCache::PathFor(script_path);
+    std::unique_ptr<suplang::SyntaxTree> cached_ast;
+    if (use_cache)
+        cached_ast = suplang::TreeCache::Load(cache_path, source->text(), cache_flags);
+
     // 1. Lexing
-    suplang::Lexer lexer(code);
+    suplang::Lexer lexer(source->text());
 
-    // 2. Parsing
-    suplang::Parser parser(lexer);
-    auto ast = parser.parseProgram();
+    // 2. Parsing. With --lazy-parse, the bodies of top-level functions are
+    // parsed when first called.
+    suplang::Parser parser(lexer, lazy_parse);
+    auto ast = cached_ast ? std::move(*cached_ast) : parser.parseProgram();
 
     // 3. Print the AST for debugging.
-    std::cout << "--- Abstract Syntax Tree ---\n";
-    PrintAST(ast.get());
-    std::cout << "--------------------------\n\n";
+    if (demo || dump_ast) {
+        std::cout << "--- Abstract Syntax Tree ---\n";
+        PrintAST(ast.get());
+        std::cout << "--------------------------\n\n";
+    }
 
-    // 4. Interpreting
-    suplang::Interpreter interpreter;
-    auto env = std::make_shared<suplang::Environment>();
-    interpreter.eval(ast.get(), env);
+    // 4. Constant folding, shared by every backend. A cached tree is already
+    // folded; a tree with parse errors is not cached.
+    if (!cached_ast) {
+        suplang::ConstantFolder folder(ast.arena());
+        folder.fold(ast.get());
+        if (use_cache && parser.errorCount() == 0 &&
+            !suplang::TreeCache::Store(cache_path, source->text(), cache_flags, ast)) {
+            std::cerr << "Could not write '" << cache_path << "'.\n";
+        }
+    }
+    if (dump_optimized_ast) {
+        std::cout << "--- Optimized Abstract Syntax Tree ---\n";
+        PrintAST(ast.get());
+        std::cout << "--------------------------------------\n\n";
+    }
 
-    std::cout << code << std::endl;
+    // 5. Name resolution, then type checking. Type errors stop the program
+    // before it runs.
+    suplang::Resolver resolver(ast.arena());
+    auto global_names = resolver.resolve(ast.get());
+    suplang::TypeChecker checker;
+    if (!checker.check(ast.get()))
+        return 1;
+
+    // 6. Interpreting
+    suplang::Value result;
+    if (backend == "stack") {
+        suplang::Compiler compiler;
+        auto program = compiler.compile(ast.get());
+        if (compiler.errorCount() > 0)
+            return 1;
+        if (dump_bytecode) {
+            std::cout << "--- Bytecode ---\n";
+            suplang::Disassemble(*program.script, std::cout);
+            std::cout << "----------------\n\n";
+        }
+        suplang::VM vm;
+        vm.run(program);
+        result = vm.getGlobal("result");
+    } else if (backend == "register") {
+        suplang::RegisterCompiler compiler;
+        auto program = compiler.compile(ast.get());
+        if (compiler.errorCount() > 0)
+            return 1;
+        if (dump_bytecode) {
+            std::cout << "--- Register Code ---\n";
+            suplang::Disassemble(*program.script, std::cout);
+            std::cout << "---------------------\n\n";
+        }
+        suplang::RegisterVM vm;
+        vm.run(program);
+        result = vm.getGlobal("result");
+    } else if (backend == "closure") {
+        suplang::ClosureCompiler compiler;
+        auto program = compiler.compile(ast.get());
+        suplang::ClosureInterpreter interpreter(gc_options);
+        interpreter.run(program);
+        result = interpreter.globals().get("result");
+        if (gc_stats)
+            PrintHeapStats(interpreter.heap());
+    } else {
+        // The jit backend is the ast backend with native code for the
+        // functions the JIT supports.
+        suplang::Interpreter interpreter(gc_options);
+        if (backend == "jit")
+            interpreter.enableJit();
+        suplang::LazyFunctions lazy_functions(source->text(), ast, std::move(global_names));
+        interpreter.setLazyFunctions(&lazy_functions);
+        // With --profile, the time of each call and statement is written to
+        // the file as collapsed stacks, and summed up on stderr.
+        std::unique_ptr<suplang::Profiler> profiler;
+        if (!profile_path.empty()) {
+            profiler = std::make_unique<suplang::Profiler>();
+            interpreter.setProfiler(profiler.get());
+        }
+        interpreter.eval(ast.get());
+        if (profiler) {
+            std::ofstream out(profile_path);
+            profiler->writeCollapsed(out);
+            if (!out)
+                std::cerr << "Could not write '" << profile_path << "'.\n";
+            std::cerr << "--- Profile ---\n";
+            profiler->writeReport(std::cerr);
+            std::cerr << "---------------\n\n";
+        }
+        // A lazily parsed body with errors stops the run when first called.
+        if (interpreter.halted())
+            return 1;
+        result = interpreter.globals().get("result");
+        if (gc_stats)
+            PrintHeapStats(interpreter.heap());
+    }
+
+    if (demo) {
+        std::cout << source->text() << std::endl;
+    }
 
     // --- Verification ---
     std::cout << "--- Execution Result ---\n";
-    auto result_obj = env->get("result");
-    if (result_obj && result_obj->type == suplang::ObjectType::INTEGER) {
-        auto int_obj = std::dynamic_pointer_cast<suplang::IntegerObject>(result_obj);
-        std::cout << "Variable 'result' has value: " << int_obj->value << std::endl;
+    if (result.isInteger()) {
+        std::cout << "Variable 'result' has value: " << result.asInteger() << std::endl;
     } else {
         std::cout << "Variable 'result' not found or not an integer." << std::endl;
     }
 
     return 0;
-}
\ No newline at end of file
+}